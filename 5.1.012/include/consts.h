@@ -48,6 +48,7 @@
 #define   MAXTOKS            40             // Max. items per line of input
 #define   MAXSTATES          10             // Max. # computed hyd. variables
 #define   MAXODES            4              // Max. # ODE's to be solved
+#define   MAXTHREADCOUNTS    32             // Max. # thread counts tried
 #define   NA                 -1             // NOT APPLICABLE code
 #define   TRUE               1              // Value for TRUE state
 #define   FALSE              0              // Value for FALSE state
@@ -109,7 +109,9 @@
       HOTSTART_FILE,                   // hotstart file
       RDII_FILE,                       // RDII file
       INFLOWS_FILE,                    // inflows interface file
-      OUTFLOWS_FILE};                  // outflows interface file
+      OUTFLOWS_FILE,                   // outflows interface file
+      TRACE_FILE,                      // trace event file
+      HOTSPOTS_FILE};                  // solver hotspots file
 
 //-------------------------------------
 // File usage types
@@ -120,6 +122,13 @@
       USE_FILE,                        // use previously saved file
       SAVE_FILE};                      // save file currently in use
 
+//-------------------------------------
+// RDII file formats
+//-------------------------------------
+ enum FileTypes {
+      BINARY,                          // binary file created by SWMM
+      TEXT};                           // text file supplied by user
+
 //-------------------------------------
 // Rain gage data types
 //-------------------------------------
@@ -383,6 +392,66 @@ enum  CompatibilityType {
       PARTIAL_DAMPING,                 // partial damping
       FULL_DAMPING};                   // full damping
 
+ enum PerfPhaseType {
+      PERF_STEP,                       // swmm_step
+      PERF_RUNOFF,                     // runoff_execute
+      PERF_ROUTING,                    // routing_execute
+      PERF_CONTROLS,                   // link settings & control rules
+      PERF_INFLOWS,                    // node losses & lateral inflows
+      PERF_FLOW_ROUTING,               // flowrout_execute
+      PERF_QUAL_ROUTING,               // qualrout_execute
+      PERF_LOSSES,                     // removal of losses & outflows
+      PERF_FLOW_STATS,                 // stats_updateFlowStats
+      PERF_OUTPUT,                     // output_saveResults
+      PERF_CHECKPOINT,                 // hotstart_checkpoint
+      MAX_PERF_PHASES};
+
+//-------------------------------------
+// Hardware events counted by perf.c
+//-------------------------------------
+ enum PerfCounterType {
+      CYCLES_COUNTER,                  // CPU cycles
+      INSTRUCTIONS_COUNTER,            // instructions retired
+      CACHE_MISSES_COUNTER,            // last level cache misses
+      BRANCH_MISSES_COUNTER,           // mispredicted branches
+      MAX_PERF_COUNTERS};
+
+//-------------------------------------
+// Phases with hardware event counts
+//-------------------------------------
+ enum CountedPhaseType {
+      COUNTED_RUNOFF,                  // runoff_execute
+      COUNTED_LINK_FLOWS,              // dynamic wave link flows
+      COUNTED_NODE_DEPTHS,             // dynamic wave node depths
+      COUNTED_QUALITY,                 // qualrout_execute
+      COUNTED_OUTPUT,                  // output_saveResults
+      MAX_COUNTED_PHASES};
+
+//-------------------------------------
+// Trace events that are not timed phases
+//-------------------------------------
+ enum TraceEventType {
+      TRACE_CONTROL_ACTIONS = MAX_PERF_PHASES};   // link settings changed
+
+//-------------------------------------
+// Memory use categories of memuse.c
+//-------------------------------------
+ enum MemoryUseType {
+      MEM_OBJECTS,                     // object arrays & their input data
+      MEM_QUALITY,                     // pollutant arrays of each object
+      MEM_ID_NAMES,                    // memory pool holding object IDs
+      MEM_HASH_TABLES,                 // object ID hash tables
+      MEM_TABLES,                      // time series & curve data points
+      MEM_RDII,                        // RDII processing arrays
+      MEM_ROUTING,                     // runoff & routing work arrays
+      MEM_STATISTICS,                  // summary & mass balance statistics
+      MEM_RESULTS,                     // binary output result buffers
+      MEM_DIAGNOSTICS,                 // trace events & CPU event counters
+      MEM_SNAPSHOTS,                   // state region list & forked state
+      MEM_COUPLING,                    // coupling data cache
+      MEM_CHECKPOINTS,                 // hot start checkpoint images queued
+      MAX_MEMORY_TYPES};
+
  enum InflowType {
       EXTERNAL_INFLOW,                 // user-supplied external inflow
       DRY_WEATHER_INFLOW,              // user-supplied dry weather inflow
@@ -484,7 +553,9 @@ enum  CompatibilityType {
       IGNORE_SNOWMELT,   IGNORE_GWATER,     IGNORE_ROUTING,
       IGNORE_QUALITY,    MAX_TRIALS,        HEAD_TOL,
       SYS_FLOW_TOL,      LAT_FLOW_TOL,      IGNORE_RDII,                       //(5.1.004)
-      MIN_ROUTE_STEP,    NUM_THREADS};                                         //(5.1.008)
+      MIN_ROUTE_STEP,    NUM_THREADS,                                          //(5.1.008)
+      SKIP_DRY_ELEMENTS, CHECKPOINT_INTERVAL, RESUME_HOTSTART,
+      PERF_STATS,        PERF_COUNTERS};
 
 enum  NoYesType {
       NO,
@@ -193,6 +193,12 @@ enum  ErrorType {
       ERR_NOT_CLOSED,           //402  101
       ERR_NOT_OPEN,             //403  102
       ERR_FILE_SIZE,            //405  103
+      ERR_STATE_BUFFER,         //407  104
+      ERR_PERF_PHASE,           //409  105
+      ERR_TRACE_FILE_OPEN,      //411  106
+      ERR_HOTSPOTS_FILE_OPEN,   //413  107
+      ERR_MEMORY_TYPE,          //415  108
+      ERR_PROGRESS_INTERVAL,    //417  109
 
       MAXERRMSG};
       
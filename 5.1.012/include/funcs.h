@@ -124,6 +124,8 @@ void    report_writeMaxStats(Project *project, TMaxStats massBalErrs[], TMaxStat
         int nMaxStats);
 void    report_writeMaxFlowTurns(Project *project, TMaxStats flowTurns[], int nMaxStats);
 void    report_writeSysStats(Project *project, TSysStats* sysStats);
+void    report_writePerfStats(Project *project);
+void    report_writePerfCounters(Project *project);
 
 void    report_writeErrorMsg(Project *project, int code, char* msg);
 void    report_writeErrorCode(Project *project);
@@ -229,6 +231,7 @@ void    rdii_openRdii(Project *project);
 void    rdii_closeRdii(Project *project);
 int     rdii_getNumRdiiFlows(Project *project, DateTime aDate);
 void    rdii_getRdiiFlow(Project *project, int index, int* node, double* q);
+size_t  rdii_getMemoryUse(Project *project);
 
 //-----------------------------------------------------------------------------
 //   Landuse Methods
@@ -264,6 +267,9 @@ void    dynwave_init(Project *project);
 void    dynwave_close(Project *project);
 double  dynwave_getRoutingStep(Project *project, double fixedStep);
 int     dynwave_execute(Project *project, double tStep);
+#ifdef SWMM_TEST
+void    dynwave_setNodeDepth(Project *project, int node, double dt);
+#endif
 void    dwflow_findConduitFlow(Project *project, int j, int steps, double omega, double dt);
 
 void    qualrout_init(Project *project);
@@ -304,14 +310,46 @@ void    massbal_addSeepageLoss(Project *project, int pollut, double seepLoss);
 void    massbal_addToFinalStorage(Project *project, int pollut, double mass);                    //(5.1.008)
 double  massbal_getStepFlowError(Project *project);
 
+//-----------------------------------------------------------------------------
+//   Phase Timing Methods
+//-----------------------------------------------------------------------------
+void    perf_open(Project *project);
+void    perf_start(Project *project, int phase);
+void    perf_stop(Project *project, int phase, int iterations);
+void    perf_close(Project *project);
+void    perf_startCount(Project *project);
+void    perf_stopCount(Project *project, int phase);
+
+//-----------------------------------------------------------------------------
+//   Simulation Tracing Methods
+//-----------------------------------------------------------------------------
+void    trace_open(Project *project);
+void    trace_close(Project *project);
+void    trace_addSpan(Project *project, int type, double start, double end,
+        int count);
+void    trace_addEvent(Project *project, int type, int count);
+
+//-----------------------------------------------------------------------------
+//   Progress Reporting Methods
+//-----------------------------------------------------------------------------
+void    progress_open(Project *project);
+void    progress_update(Project *project);
+
+//-----------------------------------------------------------------------------
+//   Memory Use Methods
+//-----------------------------------------------------------------------------
+double  memuse_getBytes(Project *project, int type);
+
 //-----------------------------------------------------------------------------
 //   Simulation Statistics Methods
 //-----------------------------------------------------------------------------
 int     stats_open(Project *project);
 void    stats_close(Project *project);
 void    stats_report(Project *project);
+void    stats_writeSolverStats(Project *project);
 
-void    stats_updateCriticalTimeCount(Project *project, int node, int link);
+void    stats_updateCriticalTimeCount(Project *project, int node, int link,
+        double tStep);
 void    stats_updateFlowStats(Project *project, double tStep, DateTime aDate, int stepCount,
         int steadyState);
 void    stats_updateSubcatchStats(Project *project, int subcatch, double rainVol, double runonVol,
@@ -352,6 +390,8 @@ double  subcatch_getDepth(Project *project, int subcatch);
 void    subcatch_getRunon(Project *project, int subcatch);
 void    subcatch_addRunonFlow(Project *project, int subcatch, double flow);                      //(5.1.008)
 double  subcatch_getRunoff(Project *project, int subcatch, double tStep);
+void    subcatch_getPrecip(Project *project, int subcatch, double *rainfall,
+        double *snowfall);
 
 double  subcatch_getWtdOutflow(Project *project, int subcatch, double wt);
 void    subcatch_getResults(Project *project, int subcatch, double wt, float x[]);
@@ -425,8 +465,21 @@ void    iface_saveOutletResults(Project *project, DateTime reportDate, FILE* fil
 //   Hot Start File Methods
 //-----------------------------------------------------------------------------
 int     hotstart_open(Project *project);
+int     hotstart_resume(Project *project);
+void    hotstart_checkpoint(Project *project);
 void    hotstart_close(Project *project);
 
+//-----------------------------------------------------------------------------
+//   State Snapshot Methods
+//-----------------------------------------------------------------------------
+size_t  snapshot_getSize(Project *project);
+int     snapshot_save(Project *project, char* state, size_t size);
+int     snapshot_restore(Project *project, const char* state, size_t size);
+void    snapshot_addRegion(Project *project, void* owner, size_t size);
+void    snapshot_close(Project *project);
+Project* snapshot_fork(Project *project);
+void    snapshot_closeFork(Project *fork);
+
 //-----------------------------------------------------------------------------
 //   Conveyance System Link Methods
 //-----------------------------------------------------------------------------
@@ -73,6 +73,8 @@ typedef struct alloc_root_s alloc_root_t;
 
 struct Project
 {
+    // --- snapshot.c treats Finp through Fhotspots as one block;
+    //     new files belong between them
     TFile Finp;                     // Input file
     TFile Fout;                     // Output file
     TFile Frpt;                     // Report file
@@ -84,6 +86,8 @@ struct Project
     TFile Fhotstart2;               // Hot start output file
     TFile Finflows;                 // Inflows routing file
     TFile Foutflows;                // Outflows routing file
+    TFile Ftrace;                   // Trace event file
+    TFile Fhotspots;                // Solver hotspots file
 
     long Nperiods;                 // Number of reporting periods
     long StepCount;                // Number of routing steps used
@@ -111,6 +115,10 @@ struct Project
     int SlopeWeighting;           // Use slope weighting
     int Compatibility;            // SWMM 5/3/4 compatibility
     int SkipSteadyState;          // Skip over steady state periods
+    int SkipDryElements;          // Skip dry nodes & links in DW routing
+    int ResumeHotstart;           // Start run when hot start file was saved
+    int PerfStats;                // Time phases of the simulation
+    int PerfCounters;             // Count CPU events in phases
     int IgnoreRainfall;           // Ignore rainfall/runoff
     int IgnoreRDII;               // Ignore RDII                     //(5.1.004)
     int IgnoreSnowmelt;           // Ignore snowmelt
@@ -126,11 +134,13 @@ struct Project
     int SweepEnd;                 // Day of year when sweeping ends
     int MaxTrials;                // Max. trials for DW routing
     int NumThreads;               // Number of parallel threads used //(5.1.008)
+    int AutoThreads;              // TRUE if NumThreads tuned at start
     int NumEvents;                // Number of detailed events       //(5.1.011)
     //InSteadyState;            // System flows remain constant    //(5.1.012)
 
     double RouteStep;                // Routing time step (sec)
     double MinRouteStep;             // Minimum variable time step (sec) //(5.1.008)
+    double CheckpointStep;           // Time between hot start checkpoints (sec)
     double LengtheningStep;          // Time step for lengthening (sec)
     double StartDryDays;             // Antecedent dry days
     double CourantFactor;            // Courant time step factor
@@ -161,6 +171,7 @@ struct Project
     double OldRoutingTime;           // Previous routing time (msec)
     double NewRoutingTime;           // Current routing time (msec)
     double TotalDuration;            // Simulation duration (msec)
+    double NextCheckpoint;           // Time of next hot start checkpoint (msec)
     double ElapsedTime;              // Current elapsed time (days)     //(5.1.011)
 
     TTemp Temp;                     // Temperature data
@@ -254,6 +265,26 @@ struct Project
     double  Omega;                  // actual under-relaxation parameter
     int     Steps;                  // number of Picard iterations
 
+    int*    ActiveNodes;            // indexes of nodes routed in current step
+    int     NumActiveNodes;         // number of active nodes
+    int*    ActiveLinks;            // indexes of links routed in current step
+    int     NumActiveLinks;         // number of active links
+    int     ActiveLinksChanged;     // TRUE if a dormant node woke up
+    int*    NodeLinkStart;          // start of each node's links in NodeLinkList
+    int*    NodeLinkList;           // links attached to each node
+    int*    NonConduitLinks;        // dummy conduits, pumps & regulators
+    int     NumNonConduitLinks;     // number of non-conduit links
+    double* LinkCost;               // measured time to route each link (sec)
+    double* NodeCost;               // measured time to route each node (sec)
+    int*    LinkWorkStart;          // first ActiveLinks entry of each thread
+    int*    NodeWorkStart;          // first ActiveNodes entry of each thread
+    int     NumWorkParts;           // number of threads work is split over
+    int     WorkPartsChanged;       // TRUE if work split must be redone
+    int     CostSampleCount;        // time steps left until costs re-measured
+    int     SampleCosts;            // TRUE if costs measured this time step
+    int     ReservedThreads;        // threads taken from the process's cores
+    TThreadTuner ThreadTuner;       // timings used to pick NumThreads
+
 
     //-----------------------------------------------------------------------------
     //  Shared variables moved from gwater.c
@@ -572,6 +603,8 @@ struct Project
     TStorageStats*  StorageStats;
     TOutfallStats*  OutfallStats;
     TPumpStats*     PumpStats;
+    TSolverStats*   NodeSolverStats;  // only kept when saving a hotspots file
+    TSolverStats*   LinkSolverStats;
     double          MaxOutfallFlow;
     double          MaxRunoffFlow;
 
@@ -652,6 +685,39 @@ struct Project
     double* R;                      // array of pollut. removals
     double* Cin;                    // node inflow concentrations
 
+    //-----------------------------------------------------------------------------
+    //  Shared variables for snapshot.c
+    //-----------------------------------------------------------------------------
+    TStateRegion* StateRegions;     // blocks of memory saved in a snapshot
+    int     NumStateRegions;        // number of state regions
+    int     MaxStateRegions;        // allocated length of StateRegions
+    size_t  StateSize;              // total size of state regions (bytes)
+    struct Project* ForkParent;     // project a forked run shares inputs with
+    char*   ForkState;              // forked run's copy of its parent's state
+    size_t  ForkStateSize;          // size of ForkState (bytes)
+
+    //-----------------------------------------------------------------------------
+    //  Shared variables for hotstart.c
+    //-----------------------------------------------------------------------------
+    void*   checkpointWriter;       // thread writing the output hot start file
+
+    //-----------------------------------------------------------------------------
+    //  Shared variables for perf.c
+    //-----------------------------------------------------------------------------
+    TPerfStats PerfTimers[MAX_PERF_PHASES]; // totals for each timed phase
+    TThreadCounters* ThreadCounters; // CPU event counters of each thread
+    int     NumThreadCounters;      // number of threads with counters
+
+    //-----------------------------------------------------------------------------
+    //  Shared variables for trace.c
+    //-----------------------------------------------------------------------------
+    TTraceBuffer Trace;             // events recorded for the trace file
+
+    //-----------------------------------------------------------------------------
+    //  Shared variables for progress.c
+    //-----------------------------------------------------------------------------
+    TProgress Progress;             // progress callback & its last call
+
     void* couplingDataCache;
 };
 
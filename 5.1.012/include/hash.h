@@ -43,6 +43,7 @@ HTtable *HTcreate(void);
 int     HTinsert(HTtable *, char *, int);
 int     HTfind(HTtable *, char *);
 char    *HTfindKey(HTtable *, char *);
+long    HTsize(HTtable *);
 void    HTfree(HTtable *);
 
 
@@ -112,6 +112,11 @@ typedef struct
 
 typedef struct Project Project;
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 //-----------------------------------------------------------------------------
 //   Infiltration Methods
 //-----------------------------------------------------------------------------
@@ -129,4 +134,8 @@ void    grnampt_initState(TGrnAmpt *infil);
 double  grnampt_getInfil(Project *project, TGrnAmpt *infil, double tstep, double irate,
         double depth, int modelType);                                          //(5.1.010)
 
+#ifdef __cplusplus
+}   // matches the linkage specification from above */
+#endif
+
 #endif //INFIL_H
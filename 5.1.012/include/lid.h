@@ -210,6 +210,8 @@ int      lid_readGroupParams(Project *project, char* tok[], int ntoks);
 
 void     lid_validate(Project *project);
 void     lid_initState(Project *project);
+void     lid_addStateRegions(Project *project);
+void     lid_detachRptFiles(Project *project);
 void     lid_setOldGroupState(Project *project, int subcatch);                                   //(5.1.008)
 
 double   lid_getPervArea(Project *project, int subcatch);
@@ -46,6 +46,11 @@ struct ExprNode
 typedef struct ExprNode MathExpr;
 typedef struct Project Project;
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 //  Creates a tokenized math expression from a string
 MathExpr* mathexpr_create(Project* project, char* s, int (*getVar) (Project*, char *));
 
@@ -55,4 +60,8 @@ double mathexpr_eval(Project* project, MathExpr* expr, double (*getVal) (Project
 //  Deletes a tokenized math expression
 void  mathexpr_delete(MathExpr* expr);
 
+#ifdef __cplusplus
+}   // matches the linkage specification from above */
+#endif
+
 #endif //MATHEXPR_H
@@ -42,5 +42,6 @@ char           *Alloc(Project *project, long);
 alloc_handle_t *AllocSetPool(Project *project, alloc_handle_t *);
 void            AllocReset(Project *project);
 void            AllocFreePool(Project *project);
+long            AllocGetSize(Project *project);
 
 #endif //MEMPOOL_H
@@ -1106,6 +1106,19 @@ typedef struct
     int           flowTurnSign;
 }  TLinkStats;
 
+//------------------
+// SOLVER STATISTICS
+//------------------
+typedef struct
+{
+    long          trials;              // DW iterations element was computed in
+    long          unconvergedTrials;   // iterations node depth missed HeadTol
+    long          unconvergedSteps;    // steps ended with node not converged
+    long          surchargedTrials;    // iterations node used surcharge method
+    long          rootEvaluations;     // storage depth & culvert root finder calls
+    double        criticalTime;        // time as Courant critical element (sec)
+}  TSolverStats;
+
 
 //-------------------------
 // MAXIMUM VALUE STATISTICS
@@ -1207,10 +1220,86 @@ typedef struct
 typedef struct
 {
     char    converged;                 // TRUE if iterations for a node done
+    char    dormant;                   // TRUE if node is dry & not routed
     double  newSurfArea;               // current surface area (ft2)
     double  oldSurfArea;               // previous surface area (ft2)
     double  sumdqdh;                   // sum of dqdh from adjoining links
     double  dYdT;                      // change in depth w.r.t. time (ft/sec)
 } TXnode;
 
+typedef struct
+{
+    int     count;                     // thread counts being tried (0 if done)
+    int     threads[MAXTHREADCOUNTS];  // thread counts being tried
+    double  time[MAXTHREADCOUNTS];     // time spent routing with each (sec)
+    long    trials[MAXTHREADCOUNTS];   // iterations made with each
+    int     step;                      // routing steps taken while tuning
+} TThreadTuner;
+
+//-----------------------------------------------------------------------------
+//  Data Structures for perf.c
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    double  time;                      // total time spent in phase (sec)
+    long    calls;                     // number of times phase was run
+    long    iterations;                // total iterations made by phase
+    double  start;                     // clock time phase last started (sec)
+} TPerfStats;
+
+typedef struct
+{
+    int     fd[MAX_PERF_COUNTERS];     // counter file descriptors (-1 if none)
+    long    tid;                       // thread the counters count
+    int     available;                 // FALSE if counters cannot be opened
+    double  start[MAX_PERF_COUNTERS];  // counts when current phase started
+    double  count[MAX_COUNTED_PHASES][MAX_PERF_COUNTERS]; // totals per phase
+} TThreadCounters;
+
+//-----------------------------------------------------------------------------
+//  Data Structures for trace.c
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    double  start;                     // clock time event started (sec)
+    double  end;                       // clock time event ended (sec)
+    double  step;                      // routing time step (sec)
+    int     type;                      // PerfPhaseType code or TraceEventType
+    int     count;                     // iterations or number of actions
+    int     converged;                 // FALSE if a routing step did not converge
+}  TTraceEvent;
+
+typedef struct
+{
+    TTraceEvent* events;               // preallocated event buffer
+    int     capacity;                  // size of event buffer
+    int     count;                     // number of events recorded
+    long    dropped;                   // events lost to a full buffer
+    int     track;                     // track (thread id) of project in trace
+    long    nonConvergeCount;          // NonConvergeCount at last routing step
+}  TTraceBuffer;
+
+//-----------------------------------------------------------------------------
+//  Data Structures for progress.c
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    void    (*callback)(void);         // an SWMM_ProgressCallback (see swmm5.h)
+    void*   userData;                  // passed back to the callback
+    double  interval;                  // wall clock time between calls (sec)
+    double  startTime;                 // clock time run started (sec)
+    double  lastTime;                  // clock time of last call (sec)
+    long    lastSteps;                 // StepCount at last call
+}  TProgress;
+
+//-----------------------------------------------------------------------------
+//  Data Structures for snapshot.c
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    void*   data;                      // start of a block of state data
+    void*   owner;                     // where the pointer to the block is kept
+    size_t  size;                      // size of the block (bytes)
+} TStateRegion;
+
 #endif //OBJECTS_H
@@ -56,6 +56,8 @@
 #endif
 #endif
 
+#include <stddef.h>
+
 // --- use "C" linkage for C++ programs
 
 #ifdef __cplusplus
@@ -64,6 +66,23 @@ extern "C" {
 
 typedef struct Project Project;
 
+// --- progress of a run passed to a progress callback
+
+typedef struct
+{
+  double simulatedTime;     // elapsed simulated time (days)
+  double totalTime;         // simulation duration (days)
+  double wallTime;          // wall clock time since the run started (sec)
+  double routingStep;       // current routing time step (sec)
+  long   steps;             // routing steps taken
+  double avgIterations;     // average iterations per non-steady routing step
+  double stepsPerSecond;    // routing steps per wall clock second since the last call
+  long   nonConvergeCount;  // routing steps that failed to converge
+} SWMM_ProgressInfo;
+
+typedef void (*SWMM_ProgressCallback)(Project *project, const SWMM_ProgressInfo *info,
+                                      void *userData);
+
 void DLLEXPORT  swmm_createProject(Project **project);
 void DLLEXPORT  swmm_deleteProject(Project* project);
 int  DLLEXPORT  swmm_run(Project *project, char* f1, char* f2, char* f3);
@@ -78,6 +97,16 @@ int  DLLEXPORT  swmm_getVersion(void);
 int  DLLEXPORT  swmm_getError(Project *project, char* errMsg, int msgLen);                      //(5.1.011)
 int  DLLEXPORT  swmm_getWarnings(Project *project);                                       //(5.1.011)
 
+int  DLLEXPORT  swmm_getStateSize(Project *project, size_t* size);
+int  DLLEXPORT  swmm_saveState(Project *project, void* state, size_t size);
+int  DLLEXPORT  swmm_restoreState(Project *project, const void* state, size_t size);
+int  DLLEXPORT  swmm_fork(Project *project, int count, Project** forks);
+int  DLLEXPORT  swmm_getPerfStats(Project *project, int phase, double* time,
+                long* calls, long* iterations);
+int  DLLEXPORT  swmm_getMemoryUse(Project *project, int type, double* bytes);
+int  DLLEXPORT  swmm_setProgressCallback(Project *project, SWMM_ProgressCallback callback,
+                double interval, void* userData);
+
 
 #ifdef __cplusplus 
 }   // matches the linkage specification from above */ 
@@ -126,6 +126,11 @@
 #define  w_IGNORE_RDII       "IGNORE_RDII"                                     //(5.1.004)
 #define  w_MIN_ROUTE_STEP    "MINIMUM_STEP"                                    //(5.1.008)
 #define  w_NUM_THREADS       "THREADS"                                         //(5.1.008)
+#define  w_SKIP_DRY_ELEMENTS "SKIP_DRY_ELEMENTS"
+#define  w_CHECKPOINT_INTERVAL "CHECKPOINT_INTERVAL"
+#define  w_RESUME_HOTSTART   "RESUME_HOTSTART"
+#define  w_PERF_STATS        "PERF_STATS"
+#define  w_PERF_COUNTERS     "PERF_COUNTERS"
 
 // Flow Units
 #define  w_CFS               "CFS"
@@ -342,6 +347,8 @@
 #define  w_ROUTING           "ROUTING"
 #define  w_INFLOWS           "INFLOWS"
 #define  w_OUTFLOWS          "OUTFLOWS"
+#define  w_TRACE             "TRACE"
+#define  w_HOTSPOTS          "HOTSPOTS"
 
 // Miscellaneous Keywords
 #define  w_OFF               "OFF"
@@ -350,6 +357,7 @@
 #define  w_YES               "YES"
 #define  w_NONE              "NONE"
 #define  w_ALL               "ALL"
+#define  w_AUTO              "AUTO"
 #define  w_SCRATCH           "SCRATCH"
 #define  w_USE               "USE"
 #define  w_SAVE              "SAVE"
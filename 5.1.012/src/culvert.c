@@ -169,6 +169,7 @@ typedef struct
     double  ad;
 	double  hPlus;                  // Intermediate terms
     TXsect* xsect;                  // Pointer to culvert cross section
+    int     evaluations;            // Times Form 1 equation was evaluated
 } TCulvert;
 
 //-----------------------------------------------------------------------------
@@ -219,6 +220,7 @@ double culvert_getInflow(Project *project, int j, double q0, double h)
 
     // --- compute often-used variables
     k = project->Link[j].subIndex;
+    culvert.evaluations = 0;
     culvert.yFull = culvert.xsect->yFull;
     culvert.ad = culvert.xsect->aFull * sqrt(culvert.yFull);
 
@@ -258,6 +260,8 @@ double culvert_getInflow(Project *project, int j, double q0, double h)
             condition = 0;
         }
     }
+    if ( project->LinkSolverStats )
+        project->LinkSolverStats[j].rootEvaluations += culvert.evaluations;
 
     // --- check if inlet controls and replace conduit's value of dq/dh
     if ( q < q0 )
@@ -403,7 +407,8 @@ double form1Eqn(Project *project, double yc, void* p)
     double ac, wc, yh;
 	TCulvert* culvert = (TCulvert *)p;
 
-        ac = xsect_getAofY(project, culvert->xsect, yc);
+    culvert->evaluations++;
+    ac = xsect_getAofY(project, culvert->xsect, yc);
     wc = xsect_getWofY(project, culvert->xsect, yc);
     yh = ac/wc;
 
@@ -59,6 +59,23 @@
 //   - Added test for failed memory allocation.
 //   - Fixed illegal array index bug for Ideal Pumps.
 //
+//   All Picard iterations of a time step run inside a single OpenMP
+//   parallel region; the phases of an iteration are separated by the
+//   barriers of the work-sharing constructs they use.
+//
+//   Conduits, orifices, weirs & outlets are routed, and node depths
+//   found, over contiguous ranges of elements whose boundaries balance
+//   the time each element took to route the last time it was measured.
+//   Costs are re-measured every COSTSAMPLESTEPS time steps.
+//
+//   With THREADS AUTO the first time steps take turns routing with 1, 2,
+//   4, ... threads, up to the cores not already taken by other projects
+//   of the process and no more than leave each thread MINLINKSPERTHREAD
+//   links. After TUNINGSTEPS timed steps at each count, the count with
+//   the least time per iteration is kept and the rest of the cores are
+//   given back. More threads must be at least MINTHREADGAIN faster to
+//   be kept.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -71,6 +88,7 @@
 #endif
 
 #include <math.h>
+#include <string.h>
 #include <omp.h>                                                               //(5.1.008)
 
 
@@ -81,6 +99,16 @@
 //-----------------------------------------------------------------------------
 static const double MINTIMESTEP =  0.001;   // min. time step (sec)            //(5.1.008)
 static const double OMEGA       =  0.5;     // under-relaxation parameter
+static const int    COSTSAMPLESTEPS = 1000; // time steps between cost samples
+static const int    TUNINGSTEPS = 20;       // time steps timed per thread count
+static const int    MINLINKSPERTHREAD = 50; // min. links per thread tried
+static const double MINTHREADGAIN = 0.05;   // min. speedup for more threads
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+//  Guarded by the swmm_threads critical section; shared by all projects.
+static int ThreadsInUse = 0;                // threads reserved by projects
 
 //  Constants moved here from project.c  //                                    //(5.1.008)
 const double DEFAULT_SURFAREA  = 12.566; // Min. nodal surface area (~4 ft diam.)
@@ -90,20 +118,37 @@ const int    DEFAULT_MAXTRIALS = 8;      // Max. trials per time step
 //-----------------------------------------------------------------------------
 //  Function declarations
 //-----------------------------------------------------------------------------
+static void   initThreads(Project *project);
+static void   tuneThreads(Project *project, double time);
+static void   releaseThreads(Project *project, int n);
+static void   findNonConduitLinks(Project *project);
 static void   initRoutingStep(Project *project);
 static void   initNodeStates(Project *project);
+static void   findDormantElements(Project *project);
+static void   findActiveLinks(Project *project);
+static void   wakeNode(Project *project, int node);
 static void   findBypassedLinks(Project *project);
 static void   findLimitedLinks(Project *project);
 
+static void   findWorkParts(Project *project, int nParts);
+static void   splitWork(int *items, int nItems, double *cost, int *start,
+              int nParts);
+static void   getWorkRange(Project *project, int *start, int nItems,
+              int *first, int *last);
+
 static void   findLinkFlows(Project *project, double dt);
 static int    isTrueConduit(Project *project, int link);
+static int    isRegulator(Project *project, int link);
 static void   findNonConduitFlow(Project *project, int link, double dt);
 static void   findNonConduitSurfArea(Project *project, int link);
 static double getModPumpFlow(Project *project, int link, double q, double dt);
 static void   updateNodeFlows(Project *project, int link);
+static void   updateConduitNodeFlows(Project *project, int node);
+static void   wakeDormantNodes(Project *project);
 
 static int    findNodeDepths(Project *project, double dt);
 static void   setNodeDepth(Project *project, int node, double dt);
+static void   updateUnconvergedSteps(Project *project);
 static double getFloodedDepth(Project *project, int node, int canPond, double dV, double yNew,
               double yMax, double dt);
 
@@ -125,11 +170,27 @@ void dynwave_init(Project *project)
     int i, j;
     double z;
 
+    initThreads(project);
     project->VariableStep = 0.0;
     project->Xnode = (TXnode *) calloc(project->Nobjects[NODE], sizeof(TXnode));
+    project->ActiveNodes = (int *) calloc(project->Nobjects[NODE], sizeof(int));
+    project->ActiveLinks = (int *) calloc(project->Nobjects[LINK], sizeof(int));
+    project->NodeLinkStart = (int *) calloc(project->Nobjects[NODE] + 1, sizeof(int));
+    project->NodeLinkList = (int *) calloc(2 * project->Nobjects[LINK] + 1, sizeof(int));
+    project->LinkCost = (double *) calloc(project->Nobjects[LINK] + 1, sizeof(double));
+    project->NodeCost = (double *) calloc(project->Nobjects[NODE] + 1, sizeof(double));
+    project->LinkWorkStart = (int *) calloc(MAX(project->NumThreads, 1) + 1, sizeof(int));
+    project->NodeWorkStart = (int *) calloc(MAX(project->NumThreads, 1) + 1, sizeof(int));
+    project->NonConduitLinks = (int *) calloc(project->Nobjects[LINK] + 1, sizeof(int));
 
 ////  Added to release 5.1.011.  ////                                          //(5.1.011)
-    if ( project->Xnode == NULL )
+    if ( project->Xnode == NULL ||
+       ( project->Nobjects[NODE] > 0 && project->ActiveNodes == NULL ) ||
+       ( project->Nobjects[LINK] > 0 && project->ActiveLinks == NULL ) ||
+         project->NodeLinkStart == NULL || project->NodeLinkList == NULL ||
+         project->LinkCost == NULL || project->NodeCost == NULL ||
+         project->LinkWorkStart == NULL || project->NodeWorkStart == NULL ||
+         project->NonConduitLinks == NULL )
     {
         report_writeErrorMsg(project, ERR_MEMORY,
             " Not enough memory for dynamic wave routing.");
@@ -142,7 +203,9 @@ void dynwave_init(Project *project)
     {
         project->Xnode[i].newSurfArea = 0.0;
         project->Xnode[i].oldSurfArea = 0.0;
+        project->Xnode[i].dormant = FALSE;
         project->Node[i].crownElev = project->Node[i].invertElev;
+        project->NodeCost[i] = 1.0;
     }
 
     // --- update node crown elev. & initialize links
@@ -156,7 +219,47 @@ void dynwave_init(Project *project)
         project->Node[j].crownElev = MAX(project->Node[j].crownElev, z);
         project->Link[i].flowClass = DRY;
         project->Link[i].dqdh = 0.0;
+        project->LinkCost[i] = 1.0;
+    }
+    project->ActiveLinksChanged = FALSE;
+    project->NumWorkParts = 0;
+    project->WorkPartsChanged = TRUE;
+    project->CostSampleCount = 1;
+    project->SampleCosts = FALSE;
+
+    // --- list the links attached to each node in order of link index
+    //     (so node flows can be summed in parallel in the same order
+    //     as a sweep over the links)
+    for (i = 0; i < project->Nobjects[LINK]; i++)
+    {
+        project->NodeLinkStart[project->Link[i].node1 + 1]++;
+        if ( project->Link[i].node2 != project->Link[i].node1 )
+            project->NodeLinkStart[project->Link[i].node2 + 1]++;
+    }
+    for (i = 0; i < project->Nobjects[NODE]; i++)
+    {
+        project->NodeLinkStart[i+1] += project->NodeLinkStart[i];
+    }
+    for (i = 0; i < project->Nobjects[LINK]; i++)
+    {
+        j = project->Link[i].node1;
+        project->NodeLinkList[project->NodeLinkStart[j]++] = i;
+        j = project->Link[i].node2;
+        if ( j != project->Link[i].node1 )
+            project->NodeLinkList[project->NodeLinkStart[j]++] = i;
+    }
+    for (i = project->Nobjects[NODE]; i > 0; i--)
+    {
+        project->NodeLinkStart[i] = project->NodeLinkStart[i-1];
     }
+    project->NodeLinkStart[0] = 0;
+
+    // --- initially all nodes & links are routed
+    for (i = 0; i < project->Nobjects[NODE]; i++) project->ActiveNodes[i] = i;
+    project->NumActiveNodes = project->Nobjects[NODE];
+    for (i = 0; i < project->Nobjects[LINK]; i++) project->ActiveLinks[i] = i;
+    project->NumActiveLinks = project->Nobjects[LINK];
+    findNonConduitLinks(project);
 }
 
 //=============================================================================
@@ -169,6 +272,16 @@ void  dynwave_close(Project *project)
 //
 {
     FREE(project->Xnode);
+    FREE(project->ActiveNodes);
+    FREE(project->ActiveLinks);
+    FREE(project->NodeLinkStart);
+    FREE(project->NodeLinkList);
+    FREE(project->LinkCost);
+    FREE(project->NodeCost);
+    FREE(project->LinkWorkStart);
+    FREE(project->NodeWorkStart);
+    FREE(project->NonConduitLinks);
+    releaseThreads(project, project->ReservedThreads);
 }
 
 //=============================================================================
@@ -230,25 +343,72 @@ int dynwave_execute(Project *project, double tStep)
 //  Purpose: routes flows through drainage network over current time step.
 //
 {
-    int converged;
+    int converged;                     // TRUE if all nodes converged
+    int unconverged;                   // number of threads w/o convergence
+    double t0 = 0.0;                   // clock time step started (sec)
 
     // --- initialize
     if ( project->ErrorCode ) return 0;
     project->Steps = 0;
     converged = FALSE;
+    unconverged = 0;
     project->Omega = OMEGA;
     initRoutingStep(project);
 
     applyCouplingNodeDepths(project);
 
-    // --- keep iterating until convergence 
+    // --- park dry nodes & links that cannot receive flow this step
+    if ( project->SkipDryElements ) findDormantElements(project);
+
+    // --- while tuning, time steps take turns using each thread count
+    if ( project->ThreadTuner.count > 0 )
+    {
+        project->NumThreads = project->ThreadTuner.threads[
+            project->ThreadTuner.step % project->ThreadTuner.count];
+        t0 = omp_get_wtime();
+    }
+
+    // --- see if the cost of routing each element is re-measured this step
+    project->SampleCosts = FALSE;
+    if ( project->NumThreads > 1 && --project->CostSampleCount <= 0 )
+    {
+        memset(project->LinkCost, 0, project->Nobjects[LINK] * sizeof(double));
+        memset(project->NodeCost, 0, project->Nobjects[NODE] * sizeof(double));
+        project->SampleCosts = TRUE;
+        project->CostSampleCount = COSTSAMPLESTEPS;
+    }
+
+    // --- keep iterating until convergence
+    //     (the functions called below contain orphaned work-sharing
+    //     constructs that bind to this single parallel region)
+#pragma omp parallel num_threads(project->NumThreads)
+{
     while ( project->Steps < project->MaxTrials )
     {
+        #pragma omp single
+        {
+            if ( project->ActiveLinksChanged ) findActiveLinks(project);
+            if ( project->WorkPartsChanged ||
+                 project->NumWorkParts != omp_get_num_threads() )
+                findWorkParts(project, omp_get_num_threads());
+            unconverged = 0;
+        }
+
         // --- execute a routing step & check for nodal convergence
         initNodeStates(project);
         findLinkFlows(project, tStep);
-        converged = findNodeDepths(project, tStep);
-        project->Steps++;
+        if ( !findNodeDepths(project, tStep) )
+        {
+            #pragma omp atomic
+            unconverged++;
+        }
+        #pragma omp barrier
+
+        #pragma omp single
+        {
+            project->Steps++;
+            converged = (unconverged == 0);
+        }
         if ( project->Steps > 1 )
         {
             if ( converged ) break;
@@ -257,15 +417,143 @@ int dynwave_execute(Project *project, double tStep)
             findBypassedLinks(project);
         }
     }
-    if ( !converged ) project->NonConvergeCount++;
 
     //  --- identify any capacity-limited conduits
     findLimitedLinks(project);
+}
+    if ( project->ThreadTuner.count > 0 ) tuneThreads(project, omp_get_wtime() - t0);
+    if ( project->SampleCosts ) project->WorkPartsChanged = TRUE;
+    if ( !converged )
+    {
+        project->NonConvergeCount++;
+        if ( project->NodeSolverStats ) updateUnconvergedSteps(project);
+    }
     return project->Steps;
 }
 
 //=============================================================================
 
+void initThreads(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: reserves the threads a project will use and, with THREADS AUTO,
+//           picks the thread counts to try.
+//
+{
+    TThreadTuner* tuner = &project->ThreadTuner;
+    int n;
+
+    // --- fixed thread counts are used as given but still count against
+    //     the cores that other projects tune their thread count within
+    #pragma omp critical (swmm_threads)
+    {
+        if ( project->AutoThreads )
+        {
+            n = MIN(project->NumThreads, omp_get_max_threads() - ThreadsInUse);
+            n = MIN(n, project->Nobjects[LINK] / MINLINKSPERTHREAD);
+            project->NumThreads = MAX(n, 1);
+        }
+        ThreadsInUse += project->NumThreads;
+        project->ReservedThreads = project->NumThreads;
+    }
+
+    tuner->count = 0;
+    tuner->step = 0;
+    if ( !project->AutoThreads || project->NumThreads == 1 ) return;
+    for (n = 1; n < project->NumThreads && tuner->count < MAXTHREADCOUNTS-1; n *= 2)
+    {
+        tuner->threads[tuner->count++] = n;
+    }
+    tuner->threads[tuner->count++] = project->NumThreads;
+    for (n = 0; n < tuner->count; n++)
+    {
+        tuner->time[n] = 0.0;
+        tuner->trials[n] = 0;
+    }
+}
+
+//=============================================================================
+
+void tuneThreads(Project *project, double time)
+//
+//  Input:   time = time taken by the current routing step (sec)
+//  Output:  none
+//  Purpose: records how long a step took with the thread count it used and
+//           keeps the fastest count once every count has been timed.
+//
+{
+    TThreadTuner* tuner = &project->ThreadTuner;
+    int    i, best;
+    double t, tBest;
+
+    // --- the first round starts up each team of threads and steps that
+    //     measure routing costs run slower, so neither is counted
+    i = tuner->step % tuner->count;
+    if ( tuner->step >= tuner->count && !project->SampleCosts )
+    {
+        tuner->time[i] += time;
+        tuner->trials[i] += project->Steps;
+    }
+    tuner->step++;
+    if ( tuner->step < (TUNINGSTEPS + 1) * tuner->count ) return;
+
+    // --- find count with least time per iteration (counts are in
+    //     increasing order)
+    best = 0;
+    tBest = BIG;
+    for (i = 0; i < tuner->count; i++)
+    {
+        if ( tuner->trials[i] == 0 ) continue;
+        t = tuner->time[i] / tuner->trials[i];
+        if ( t < (1.0 - MINTHREADGAIN) * tBest )
+        {
+            best = i;
+            tBest = t;
+        }
+    }
+    project->NumThreads = tuner->threads[best];
+    tuner->count = 0;
+    releaseThreads(project, project->ReservedThreads - project->NumThreads);
+}
+
+//=============================================================================
+
+void releaseThreads(Project *project, int n)
+//
+//  Input:   n = number of threads
+//  Output:  none
+//  Purpose: gives back threads a project no longer uses.
+//
+{
+    #pragma omp critical (swmm_threads)
+    {
+        ThreadsInUse -= n;
+        project->ReservedThreads -= n;
+    }
+}
+
+//=============================================================================
+
+void findNonConduitLinks(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: lists the non-conduit links in index order.
+//
+{
+    int i;
+
+    project->NumNonConduitLinks = 0;
+    for (i = 0; i < project->Nobjects[LINK]; i++)
+    {
+        if ( !isTrueConduit(project, i) )
+            project->NonConduitLinks[project->NumNonConduitLinks++] = i;
+    }
+}
+
+//=============================================================================
+
 void   initRoutingStep(Project *project)
 {
     int i;
@@ -294,10 +582,13 @@ void initNodeStates(Project *project)
 //  Purpose: initializes node's surface area, inflow & outflow
 //
 {
-    int i;
+    int i, n;
 
-    for (i = 0; i < project->Nobjects[NODE]; i++)
+    #pragma omp for
+    for (n = 0; n < project->NumActiveNodes; n++)
     {
+        i = project->ActiveNodes[n];
+
         // --- initialize nodal surface area
         if ( project->AllowPonding )
         {
@@ -330,11 +621,126 @@ void initNodeStates(Project *project)
 
 //=============================================================================
 
-void   findBypassedLinks(Project *project)
+void findDormantElements(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: identifies dry nodes that receive no inflow and whose connecting
+//           conduits carry no flow, so they can be skipped over the
+//           current time step.
+//
+{
+    int i, k, n1, n2;
+
+    // --- a node can sleep if it is dry and has no lateral flow or losses
+    for (i = 0; i < project->Nobjects[NODE]; i++)
+    {
+        project->Xnode[i].dormant =
+            ( project->Node[i].type != OUTFALL &&
+              !project->Node[i].depthSetExternally &&
+              project->Node[i].newDepth <= FUDGE &&
+              project->Node[i].newLatFlow == 0.0 &&
+              project->Node[i].oldNetInflow == 0.0 &&
+              project->Node[i].losses == 0.0 );
+    }
+
+    // --- nodes attached to a wet or non-conduit link must stay active
+    for (i = 0; i < project->Nobjects[LINK]; i++)
+    {
+        n1 = project->Link[i].node1;
+        n2 = project->Link[i].node2;
+        if ( !project->Xnode[n1].dormant && !project->Xnode[n2].dormant ) continue;
+        if ( isTrueConduit(project, i) &&
+             project->Link[i].newFlow == 0.0 &&
+             project->Link[i].oldFlow == 0.0 )
+        {
+            k = project->Link[i].subIndex;
+            if ( project->Conduit[k].evapLossRate == 0.0 &&
+                 project->Conduit[k].seepLossRate == 0.0 ) continue;
+        }
+        project->Xnode[n1].dormant = FALSE;
+        project->Xnode[n2].dormant = FALSE;
+    }
+
+    // --- collect the active nodes; dormant nodes keep their current state
+    project->NumActiveNodes = 0;
+    for (i = 0; i < project->Nobjects[NODE]; i++)
+    {
+        if ( project->Xnode[i].dormant )
+        {
+            project->Xnode[i].converged = TRUE;
+            project->Node[i].inflow = 0.0;
+            project->Node[i].outflow = 0.0;
+            project->Node[i].overflowAndInflow = 0.0;
+        }
+        else project->ActiveNodes[project->NumActiveNodes++] = i;
+    }
+    findActiveLinks(project);
+}
+
+//=============================================================================
+
+void findActiveLinks(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: lists the links that have at least one active end node.
+//
 {
     int i;
+
+    project->NumActiveLinks = 0;
     for (i = 0; i < project->Nobjects[LINK]; i++)
     {
+        if ( project->Xnode[project->Link[i].node1].dormant &&
+             project->Xnode[project->Link[i].node2].dormant )
+        {
+            project->Link[i].dqdh = 0.0;
+            continue;
+        }
+        project->ActiveLinks[project->NumActiveLinks++] = i;
+    }
+    project->ActiveLinksChanged = FALSE;
+    project->WorkPartsChanged = TRUE;
+}
+
+//=============================================================================
+
+void wakeNode(Project *project, int i)
+//
+//  Input:   i = node index
+//  Output:  none
+//  Purpose: returns a dormant node to the set of routed nodes after one of
+//           its links starts to exchange flow with it.
+//
+{
+    project->Xnode[i].dormant = FALSE;
+    project->Xnode[i].converged = FALSE;
+    project->Xnode[i].sumdqdh = 0.0;
+    if ( project->AllowPonding )
+        project->Xnode[i].newSurfArea = node_getPondedArea(project, i, project->Node[i].newDepth);
+    else
+        project->Xnode[i].newSurfArea = node_getSurfArea(project, i, project->Node[i].newDepth);
+    if ( project->Xnode[i].newSurfArea < project->MinSurfArea )
+        project->Xnode[i].newSurfArea = project->MinSurfArea;
+    project->Node[i].inflow = 0.0;
+    project->Node[i].outflow = 0.0;
+    project->ActiveNodes[project->NumActiveNodes++] = i;
+
+    // --- links to the node's other dormant neighbors join on next iteration
+    project->ActiveLinksChanged = TRUE;
+}
+
+//=============================================================================
+
+void   findBypassedLinks(Project *project)
+{
+    int i, n;
+
+    #pragma omp for
+    for (n = 0; n < project->NumActiveLinks; n++)
+    {
+        i = project->ActiveLinks[n];
         if ( project->Xnode[project->Link[i].node1].converged &&
              project->Xnode[project->Link[i].node2].converged )
              project->Link[i].bypassed = TRUE;
@@ -351,11 +757,14 @@ void  findLimitedLinks(Project *project)
 //  Purpose: determines if a conduit link is capacity limited.
 //
 {
-    int    j, n1, n2, k;
+    int    j, n, n1, n2, k;
     double h1, h2;
 
-    for (j = 0; j < project->Nobjects[LINK]; j++)
+    #pragma omp for
+    for (n = 0; n < project->NumActiveLinks; n++)
     {
+        j = project->ActiveLinks[n];
+
         // ---- check only non-dummy conduit links
         if ( !isTrueConduit(project, j) ) continue;                                     //(5.1.008)
 
@@ -377,36 +786,142 @@ void  findLimitedLinks(Project *project)
 
 //=============================================================================
 
-void findLinkFlows(Project *project, double dt)
+void findWorkParts(Project *project, int nParts)
+//
+//  Input:   nParts = number of threads sharing the work
+//  Output:  none
+//  Purpose: splits the active links and active nodes into ranges of equal
+//           measured routing cost, one for each thread.
+//
 {
-    int i;
+    nParts = MIN(nParts, MAX(project->NumThreads, 1));
+    splitWork(project->ActiveLinks, project->NumActiveLinks, project->LinkCost,
+              project->LinkWorkStart, nParts);
+    splitWork(project->ActiveNodes, project->NumActiveNodes, project->NodeCost,
+              project->NodeWorkStart, nParts);
+    project->NumWorkParts = nParts;
+    project->WorkPartsChanged = FALSE;
+}
+
+//=============================================================================
 
-    // --- find new flow in each non-dummy conduit
-#pragma omp parallel num_threads(project->NumThreads)                                   //(5.1.008)
+void splitWork(int *items, int nItems, double *cost, int *start, int nParts)
+//
+//  Input:   items  = indexes of the elements to be split
+//           nItems = number of elements
+//           cost   = cost of each element (indexed by element index)
+//           start  = position in items where each part begins
+//           nParts = number of parts
+//  Output:  none
+//  Purpose: finds the boundaries of nParts contiguous ranges of items that
+//           have nearly equal total cost.
+//
 {
-    #pragma omp for                                                            //(5.1.008)
-    for ( i = 0; i < project->Nobjects[LINK]; i++)
+    int    k, p;
+    double total = 0.0;
+    double sum = 0.0;
+
+    for (k = 0; k < nItems; k++) total += cost[items[k]];
+
+    // --- split evenly by count if no costs have been measured
+    if ( total <= 0.0 )
     {
-        if ( isTrueConduit(project, i) && !project->Link[i].bypassed )
-            dwflow_findConduitFlow(project, i, project->Steps, project->Omega, dt);
+        for (p = 0; p <= nParts; p++) start[p] = nItems * p / nParts;
+        return;
+    }
+    start[0] = 0;
+    p = 1;
+    for (k = 0; k < nItems && p < nParts; k++)
+    {
+        while ( p < nParts && sum >= total * p / nParts ) start[p++] = k;
+        sum += cost[items[k]];
     }
+    while ( p <= nParts ) start[p++] = nItems;
 }
 
+//=============================================================================
+
+void getWorkRange(Project *project, int *start, int nItems, int *first, int *last)
+//
+//  Input:   start  = position where each thread's range of items begins
+//           nItems = current number of items
+//  Output:  first = position of first item for calling thread
+//           last  = position after last item for calling thread
+//  Purpose: finds the range of items routed by the calling thread.
+//
+//  Note:    the last thread also takes any nodes woken up since the
+//           ranges were found.
+//
+{
+    int t = omp_get_thread_num();
+
+    if ( t >= project->NumWorkParts )
+    {
+        *first = *last = nItems;
+        return;
+    }
+    *first = start[t];
+    if ( t == project->NumWorkParts - 1 ) *last = nItems;
+    else *last = start[t+1];
+}
+
+//=============================================================================
+
+void findLinkFlows(Project *project, double dt)
+{
+    int i, n, first, last;
+    double t0 = 0.0;
+
+    perf_startCount(project);
+
+    // --- find new flow in each non-dummy conduit & each regulator
+    //     (these depend only on node depths & their own state)
+    getWorkRange(project, project->LinkWorkStart, project->NumActiveLinks,
+                 &first, &last);
+    for ( n = first; n < last; n++)
+    {
+        i = project->ActiveLinks[n];
+        if ( project->Link[i].bypassed ) continue;
+        if ( project->SampleCosts ) t0 = omp_get_wtime();
+        if ( isTrueConduit(project, i) )
+            dwflow_findConduitFlow(project, i, project->Steps, project->Omega, dt);
+        else if ( isRegulator(project, i) )
+            findNonConduitFlow(project, i, dt);
+        else continue;
+        if ( project->SampleCosts ) project->LinkCost[i] += omp_get_wtime() - t0;
+        if ( project->LinkSolverStats ) project->LinkSolverStats[i].trials++;
+    }
+    #pragma omp barrier
+
     // --- update inflow/outflows for nodes attached to non-dummy conduits
-    for ( i = 0; i < project->Nobjects[LINK]; i++)
+    #pragma omp for
+    for ( n = 0; n < project->NumActiveNodes; n++)
     {
-        if ( isTrueConduit(project, i) ) updateNodeFlows(project, i);
+        updateConduitNodeFlows(project, project->ActiveNodes[n]);
     }
 
-    // --- find new flows for all dummy conduits, pumps & regulators
-    for ( i = 0; i < project->Nobjects[LINK]; i++)
+    #pragma omp single
     {
-        if ( !isTrueConduit(project, i) )
-        {	
-            if ( !project->Link[i].bypassed ) findNonConduitFlow(project, i, dt);
+        // --- bring back any dormant node that now receives conduit flow
+        if ( project->SkipDryElements ) wakeDormantNodes(project);
+
+        // --- find new flows for dummy conduits & pumps and add all
+        //     non-conduit flows to their nodes in link index order
+        //     (these flows depend on node inflows summed so far;
+        //     non-conduit links are never dormant)
+        for ( n = 0; n < project->NumNonConduitLinks; n++)
+        {
+            i = project->NonConduitLinks[n];
+            if ( !project->Link[i].bypassed && !isRegulator(project, i) )
+            {
+                findNonConduitFlow(project, i, dt);
+                if ( project->LinkSolverStats )
+                    project->LinkSolverStats[i].trials++;
+            }
             updateNodeFlows(project, i);
         }
     }
+    perf_stopCount(project, COUNTED_LINK_FLOWS);
 }
 
 //=============================================================================
@@ -418,6 +933,15 @@ int isTrueConduit(Project *project, int j)
 
 //=============================================================================
 
+int isRegulator(Project *project, int j)
+{
+    return ( project->Link[j].type == ORIFICE ||
+             project->Link[j].type == WEIR ||
+             project->Link[j].type == OUTLET );
+}
+
+//=============================================================================
+
 void findNonConduitFlow(Project *project, int i, double dt)
 //
 //  Input:   i = link index
@@ -583,24 +1107,113 @@ void updateNodeFlows(Project *project, int i)
 
 //=============================================================================
 
+void updateConduitNodeFlows(Project *project, int i)
+//
+//  Input:   i = node index
+//  Output:  none
+//  Purpose: adds the flow, surface area & dqdh contributions of all
+//           non-dummy conduits attached to a node.
+//
+//  Note:    contributions are summed in order of link index so that the
+//           result matches a serial sweep of updateNodeFlows over links.
+//
+{
+    int    j, k, m;
+    double q, uniformLossRate;
+    TNode*  node = &project->Node[i];
+    TXnode* xnode = &project->Xnode[i];
+
+    for (m = project->NodeLinkStart[i]; m < project->NodeLinkStart[i+1]; m++)
+    {
+        j = project->NodeLinkList[m];
+        if ( !isTrueConduit(project, j) ) continue;
+        k = project->Link[j].subIndex;
+        q = project->Link[j].newFlow;
+        uniformLossRate = project->Conduit[k].evapLossRate +
+                          project->Conduit[k].seepLossRate;
+
+        // --- node is at the upstream end of the conduit
+        if ( project->Link[j].node1 == i )
+        {
+            if ( q >= 0.0 ) node->outflow += q + uniformLossRate;
+            else            node->inflow  -= q;
+            xnode->newSurfArea += project->Link[j].surfArea1 * project->Conduit[k].barrels;
+            xnode->sumdqdh += project->Link[j].dqdh;
+        }
+
+        // --- node is at the downstream end of the conduit
+        if ( project->Link[j].node2 == i )
+        {
+            if ( q >= 0.0 ) node->inflow   += q;
+            else            node->outflow  -= q - uniformLossRate;
+            xnode->newSurfArea += project->Link[j].surfArea2 * project->Conduit[k].barrels;
+            xnode->sumdqdh += project->Link[j].dqdh;
+        }
+    }
+}
+
+//=============================================================================
+
+void wakeDormantNodes(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: returns to the active set any dormant node attached to a
+//           conduit that now carries flow.
+//
+{
+    int    i, k, n, m;
+    int    ends[2];
+
+    for (n = 0; n < project->NumActiveLinks; n++)
+    {
+        i = project->ActiveLinks[n];
+        if ( !isTrueConduit(project, i) ) continue;
+        k = project->Link[i].subIndex;
+        if ( project->Link[i].newFlow == 0.0 &&
+             project->Conduit[k].evapLossRate == 0.0 &&
+             project->Conduit[k].seepLossRate == 0.0 ) continue;
+        ends[0] = project->Link[i].node1;
+        ends[1] = project->Link[i].node2;
+        for (m = 0; m < 2; m++)
+        {
+            if ( !project->Xnode[ends[m]].dormant ) continue;
+            wakeNode(project, ends[m]);
+            updateConduitNodeFlows(project, ends[m]);
+        }
+    }
+}
+
+//=============================================================================
+
 int findNodeDepths(Project *project, double dt)
 {
-    int i;
+    int i, n, first, last;
     int converged;      // convergence flag
     double yOld;        // previous node depth (ft)
+    double t0 = 0.0;    // start time of a node's cost measurement (sec)
+
+    perf_startCount(project);
 
     // --- compute outfall depths based on flow in connecting link
-    for ( i = 0; i < project->Nobjects[LINK]; i++ ) link_setOutfallDepth(project, i);
+    //     (non-outfall nodes below do not depend on them)
+    #pragma omp single nowait
+    for ( n = 0; n < project->NumActiveLinks; n++ )
+    {
+        link_setOutfallDepth(project, project->ActiveLinks[n]);
+    }
 
     // --- compute new depth for all non-outfall nodes and determine if
     //     depth change from previous iteration is below tolerance
+    //     (converged is private to each thread & reduced by the caller)
     converged = TRUE;
-#pragma omp parallel num_threads(project->NumThreads)                                   //(5.1.008)
-{
-    #pragma omp for private(yOld)                                              //(5.1.008)
-    for ( i = 0; i < project->Nobjects[NODE]; i++ )
+    getWorkRange(project, project->NodeWorkStart, project->NumActiveNodes,
+                 &first, &last);
+    for ( n = first; n < last; n++ )
     {
+        i = project->ActiveNodes[n];
         if ( project->Node[i].type == OUTFALL ) continue;
+        if ( project->SampleCosts ) t0 = omp_get_wtime();
         yOld = project->Node[i].newDepth;
         setNodeDepth(project, i, dt);
         project->Xnode[i].converged = TRUE;
@@ -609,13 +1222,41 @@ int findNodeDepths(Project *project, double dt)
             converged = FALSE;
             project->Xnode[i].converged = FALSE;
         }
+        if ( project->SampleCosts ) project->NodeCost[i] += omp_get_wtime() - t0;
+        if ( project->NodeSolverStats )
+        {
+            project->NodeSolverStats[i].trials++;
+            if ( !project->Xnode[i].converged )
+                project->NodeSolverStats[i].unconvergedTrials++;
+        }
     }
-}                                                                              //(5.1.008)
+    perf_stopCount(project, COUNTED_NODE_DEPTHS);
     return converged;
 }
 
 //=============================================================================
 
+void updateUnconvergedSteps(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: counts a failed time step against each node that had not
+//           converged when the iterations ran out.
+//
+{
+    int i, n;
+
+    for ( n = 0; n < project->NumActiveNodes; n++ )
+    {
+        i = project->ActiveNodes[n];
+        if ( project->Node[i].type == OUTFALL ) continue;
+        if ( !project->Xnode[i].converged )
+            project->NodeSolverStats[i].unconvergedSteps++;
+    }
+}
+
+//=============================================================================
+
 void setNodeDepth(Project *project, int i, double dt)
 //
 //  Input:   i  = node index
@@ -679,6 +1320,9 @@ void setNodeDepth(Project *project, int i, double dt)
     //     iteration; also, do not apply under-relaxation.
     else
     {
+        if ( project->NodeSolverStats )
+            project->NodeSolverStats[i].surchargedTrials++;
+
         // --- apply correction factor for upstream terminal nodes
         corr = 1.0;
         if ( project->Node[i].degree < 0 ) corr = 0.6;
@@ -798,11 +1442,11 @@ double getVariableStep(Project *project, double maxStep)
         minLink = -1;
     }
 
-    // --- update count of times the minimum node or link was critical
-    stats_updateCriticalTimeCount(project, minNode, minLink);
-
     // --- don't let time step go below an absolute minimum
     if ( tMin < project->MinRouteStep ) tMin = project->MinRouteStep;                            //(5.1.008)
+
+    // --- update count of times the minimum node or link was critical
+    stats_updateCriticalTimeCount(project, minNode, minLink, tMin);
     return tMin;
 }
 
@@ -894,3 +1538,18 @@ double getNodeStep(Project *project, double tMin, int *minNode)
     }
     return tNode;
 }
+
+#ifdef SWMM_TEST
+//=============================================================================
+
+void dynwave_setNodeDepth(Project *project, int i, double dt)
+//
+//  Input:   i  = node index
+//           dt = time step (sec)
+//  Output:  none
+//  Purpose: gives the benchmark suite access to setNodeDepth.
+//
+{
+    setNodeDepth(project, i, dt);
+}
+#endif
@@ -188,6 +188,14 @@
 #define ERR405 \
   "\n  ERROR 405: amount of output produced will exceed maximum file size;" \
   "\n             either reduce Ending Date or increase Reporting Time Step."
+#define ERR407 \
+  "\n  ERROR 407: state buffer is too small or was not saved from the current run."
+#define ERR409 \
+  "\n  ERROR 409: invalid timed phase code."
+#define ERR411 "\n  ERROR 411: cannot open trace file %s."
+#define ERR413 "\n  ERROR 413: cannot open solver hotspots file %s."
+#define ERR415 "\n  ERROR 415: invalid memory use category."
+#define ERR417 "\n  ERROR 417: invalid progress reporting interval."
 
 ////////////////////////////////////////////////////////////////////////////
 //  NOTE: Need to update ErrorMsgs[], ErrorCodes[], and ErrorType
@@ -206,7 +214,8 @@ char* ErrorMsgs[] =
   ERR313, ERR315, ERR317, ERR318, ERR319, ERR320, ERR321, ERR323, ERR325,
   ERR327, ERR329, ERR330, ERR331, ERR333, ERR335, ERR336, ERR337, ERR338,
   ERR339, ERR341, ERR343, ERR345, ERR351, ERR353, ERR355, ERR357, ERR361,
-  ERR363, ERR401, ERR402, ERR403, ERR405};
+  ERR363, ERR401, ERR402, ERR403, ERR405, ERR407, ERR409, ERR411,
+  ERR413, ERR415, ERR417};
 
 int ErrorCodes[] =
 { 0,      101,    103,    105,    107,    108,    109,    110,    111,
@@ -220,7 +229,8 @@ int ErrorCodes[] =
   313,    315,    317,    318,    319,    320,    321,    323,    325,
   327,    329,    330,    331,    333,    335,    336,    337,    338,
   339,    341,    343,    345,    351,    353,    355,    357,    361,
-  363,    401,    402,    403,    405};
+  363,    401,    402,    403,    405,    407,    409,    411,
+  413,    415,    417};
 
 char ErrString[256];
 
@@ -33,6 +33,7 @@
 //      HTcreate() - creates a hash table
 //      HTinsert() - inserts a string & its index value into a hash table
 //      HTfind()   - retrieves the index value of a string from a table
+//      HTsize()   - finds the memory used by a hash table
 //      HTfree()   - frees a hash table
 //-----------------------------------------------------------------------------
 
@@ -129,6 +130,19 @@ char *HTfindKey(HTtable *ht, char *key)
   return(NULL);
 }
 
+long HTsize(HTtable *ht)
+{
+  struct HTentry *entry;
+  long size = HTMAXSIZE * sizeof(HTtable);
+  int i;
+  for (i=0; i<HTMAXSIZE; i++)
+  {
+    for (entry = ht[i]; entry != NULL; entry = entry->next)
+      size += sizeof(struct HTentry);
+  }
+  return(size);
+}
+
 void HTfree(HTtable *ht)
 {
   struct HTentry *entry,
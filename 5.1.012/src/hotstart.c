@@ -58,6 +58,14 @@
 //   Build 5.1.011:
 //   - Link control setting bug when reading a hot start file fixed.    
 //
+//   Version 5 of the file saves node and link states in double precision
+//   and records the date and time at which the state was saved. With the
+//   CHECKPOINT_INTERVAL option the output hot start file is also saved
+//   periodically during a run, so that a run that was cut short can be
+//   resumed from its last checkpoint with the RESUME_HOTSTART option.
+//   Each save copies the project's state into memory on the simulation
+//   thread and leaves writing it to disk to a checkpoint writer thread.
+//
 //-----------------------------------------------------------------------------
 #define _CRT_SECURE_NO_DEPRECATE
 
@@ -66,11 +74,24 @@
 #include <string.h>
 #include <math.h>
 #include "headers.h"
+#include "checkpointwriter.h"
+
+//-----------------------------------------------------------------------------
+//  Local data structures
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    char*  data;                       // image of a hot start file
+    size_t size;                       // bytes written to image
+    size_t capacity;                   // bytes allocated for image
+}  TStateBuffer;
 
 //-----------------------------------------------------------------------------
 //  External functions (declared in funcs.h)
 //-----------------------------------------------------------------------------
 // hotstart_open                          (called by swmm_start in swmm5.c)
+// hotstart_resume                        (called by project_readInput)
+// hotstart_checkpoint                    (called by swmm_step in swmm5.c)
 // hotstart_close                         (called by swmm_end in swmm5.c)      //(5.1.005)
 
 //-----------------------------------------------------------------------------
@@ -79,11 +100,15 @@
 static int  openHotstartFile1(Project *project);
 static int  openHotstartFile2(Project *project);
 static void readRunoff(Project *project);
-static void saveRunoff(Project *project);
+static void saveRunoff(Project *project, TStateBuffer* buffer);
 static void readRouting(Project *project);
-static void saveRouting(Project *project);
+static void saveRouting(Project *project, TStateBuffer* buffer);
+static int  saveState(Project *project);
+static void writeState(TStateBuffer* buffer, const void* x, size_t size,
+            size_t count);
 static int  readFloat(Project *project, float *x, FILE* f);
 static int  readDouble(Project *project, double* x, FILE* f);
+static int  readRoutingValue(Project *project, double* x, FILE* f);
 
 //=============================================================================
 
@@ -106,13 +131,81 @@ int hotstart_open(Project *project)
 
 //=============================================================================
 
+int hotstart_resume(Project *project)
+//
+//  Input:   none
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: moves the start of the simulation to the date and time at which
+//           the input hot start file was saved.
+//
+{
+    int      counts[6];
+    DateTime saveDate;
+    char     fileStamp[] = "SWMM5-HOTSTART5";
+    char     fStamp[]    = "SWMM5-HOTSTARTx";
+    FILE*    f;
+
+    if ( project->Fhotstart1.mode != USE_FILE ) return TRUE;
+    if ( (f = fopen(project->Fhotstart1.name, "rb")) == NULL )
+    {
+        report_writeErrorMsg(project, ERR_HOTSTART_FILE_OPEN, project->Fhotstart1.name);
+        return FALSE;
+    }
+
+    // --- only version 5 files record when they were saved
+    if ( fread(fStamp, sizeof(char), strlen(fileStamp), f) != strlen(fileStamp)
+    ||   strcmp(fStamp, fileStamp) != 0
+    ||   fread(counts, sizeof(int), 6, f) != 6
+    ||   fread(&saveDate, sizeof(DateTime), 1, f) != 1 )
+    {
+        fclose(f);
+        report_writeErrorMsg(project, ERR_HOTSTART_FILE_FORMAT, "");
+        return FALSE;
+    }
+    fclose(f);
+
+    project->StartDate = floor(saveDate);
+    project->StartTime = saveDate - project->StartDate;
+    return TRUE;
+}
+
+//=============================================================================
+
+void hotstart_checkpoint(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: saves the current state to the output hot start file once the
+//           next checkpoint time has been reached.
+//
+{
+    if ( project->checkpointWriter == NULL ) return;
+    if ( project->CheckpointStep <= 0.0 ) return;
+    if ( project->NewRoutingTime < project->NextCheckpoint ) return;
+
+    // --- the final state is saved by hotstart_close
+    if ( project->NewRoutingTime >= project->TotalDuration ) return;
+
+    perf_start(project, PERF_CHECKPOINT);
+    saveState(project);
+    perf_stop(project, PERF_CHECKPOINT, 0);
+    while ( project->NextCheckpoint <= project->NewRoutingTime )
+    {
+        project->NextCheckpoint += 1000.0 * project->CheckpointStep;
+    }
+}
+
+//=============================================================================
+
 void hotstart_close(Project *project)
 {
-    if ( project->Fhotstart2.file )
+    if ( project->checkpointWriter )
     {
-        saveRunoff(project);
-        saveRouting(project);
-        fclose(project->Fhotstart2.file);
+        saveState(project);
+        if ( !stopCheckpointWriter(project) )
+        {
+            report_writeErrorMsg(project, ERR_HOTSTART_FILE_OPEN, project->Fhotstart2.name);
+        }
     }
 }
 
@@ -137,6 +230,8 @@ int openHotstartFile1(Project *project)
     char  fileStamp2[] = "SWMM5-HOTSTART2";
     char  fileStamp3[] = "SWMM5-HOTSTART3";
     char  fileStamp4[] = "SWMM5-HOTSTART4";                                    //(5.1.008)
+    char  fileStamp5[] = "SWMM5-HOTSTART5";
+    DateTime saveDate;
 
     // --- try to open the file
     if ( project->Fhotstart1.mode != USE_FILE ) return TRUE;
@@ -148,7 +243,8 @@ int openHotstartFile1(Project *project)
 
     // --- check that file contains proper header records
     fread(fStampx, sizeof(char), strlen(fileStamp2), project->Fhotstart1.file);
-    if      ( strcmp(fStampx, fileStamp4) == 0 ) project->fileVersion = 4;              //(5.1.008)
+    if      ( strcmp(fStampx, fileStamp5) == 0 ) project->fileVersion = 5;
+    else if ( strcmp(fStampx, fileStamp4) == 0 ) project->fileVersion = 4;              //(5.1.008)
     else if ( strcmp(fStampx, fileStamp3) == 0 ) project->fileVersion = 3;
     else if ( strcmp(fStampx, fileStamp2) == 0 ) project->fileVersion = 2;
     else
@@ -184,6 +280,10 @@ int openHotstartFile1(Project *project)
     fread(&nLinks, sizeof(int), 1, project->Fhotstart1.file);
     fread(&nPollut, sizeof(int), 1, project->Fhotstart1.file);
     fread(&flowUnits, sizeof(int), 1, project->Fhotstart1.file);
+    if ( project->fileVersion >= 5 )
+    {
+        fread(&saveDate, sizeof(DateTime), 1, project->Fhotstart1.file);
+    }
     if ( nSubcatch != project->Nobjects[SUBCATCH]
     ||   nLandUses != project->Nobjects[LANDUSE]
     ||   nNodes    != project->Nobjects[NODE]
@@ -209,85 +309,151 @@ int openHotstartFile2(Project *project)
 //
 //  Input:   none
 //  Output:  none
-//  Purpose: opens a new routing hotstart file to save results to.
+//  Purpose: checks that a new routing hotstart file can be saved and starts
+//           the thread that writes it.
 //
 {
-    int   nSubcatch;
-    int   nLandUses;
-    int   nNodes;
-    int   nLinks;
-    int   nPollut;
-    int   flowUnits;
-    char  fileStamp[] = "SWMM5-HOTSTART4";                                     //(5.1.008)
+    FILE* f;
 
-    // --- try to open file
+    // --- check that the file can be written to without erasing it
+    //     (it may also be the file the run was started from)
     if ( project->Fhotstart2.mode != SAVE_FILE ) return TRUE;
-    if ( (project->Fhotstart2.file = fopen(project->Fhotstart2.name, "w+b")) == NULL)
+    if ( (f = fopen(project->Fhotstart2.name, "ab")) == NULL)
     {
         report_writeErrorMsg(project, ERR_HOTSTART_FILE_OPEN, project->Fhotstart2.name);
         return FALSE;
     }
+    fclose(f);
 
-    // --- write file stamp & number of objects to file
-    nSubcatch = project->Nobjects[SUBCATCH];
-    nLandUses = project->Nobjects[LANDUSE];
-    nNodes = project->Nobjects[NODE];
-    nLinks = project->Nobjects[LINK];
-    nPollut = project->Nobjects[POLLUT];
-    flowUnits = project->FlowUnits;
-    fwrite(fileStamp, sizeof(char), strlen(fileStamp), project->Fhotstart2.file);
-    fwrite(&nSubcatch, sizeof(int), 1, project->Fhotstart2.file);
-    fwrite(&nLandUses, sizeof(int), 1, project->Fhotstart2.file);
-    fwrite(&nNodes, sizeof(int), 1, project->Fhotstart2.file);
-    fwrite(&nLinks, sizeof(int), 1, project->Fhotstart2.file);
-    fwrite(&nPollut, sizeof(int), 1, project->Fhotstart2.file);
-    fwrite(&flowUnits, sizeof(int), 1, project->Fhotstart2.file);
+    if ( !startCheckpointWriter(project, project->Fhotstart2.name) )
+    {
+        report_writeErrorMsg(project, ERR_HOTSTART_FILE_OPEN, project->Fhotstart2.name);
+        return FALSE;
+    }
+    project->NextCheckpoint = 1000.0 * project->CheckpointStep;
     return TRUE;
 }
 
 //=============================================================================
 
-void  saveRouting(Project *project)
+int saveState(Project *project)
 //
 //  Input:   none
+//  Output:  returns TRUE if successful, FALSE if not
+//  Purpose: copies the current state of the project into an image of a
+//           hot start file and passes it on to the checkpoint writer.
+//
+{
+    int      counts[6];
+    DateTime saveDate;
+    char     fileStamp[] = "SWMM5-HOTSTART5";
+    TStateBuffer buffer = {NULL, 0, 0};
+
+    // --- write file stamp, number of objects & date of state
+    counts[0] = project->Nobjects[SUBCATCH];
+    counts[1] = project->Nobjects[LANDUSE];
+    counts[2] = project->Nobjects[NODE];
+    counts[3] = project->Nobjects[LINK];
+    counts[4] = project->Nobjects[POLLUT];
+    counts[5] = project->FlowUnits;
+    saveDate = getDateTime(project, project->NewRoutingTime);
+    writeState(&buffer, fileStamp, sizeof(char), strlen(fileStamp));
+    writeState(&buffer, counts, sizeof(int), 6);
+    writeState(&buffer, &saveDate, sizeof(DateTime), 1);
+
+    // --- write state of subcatchments, nodes & links
+    saveRunoff(project, &buffer);
+    saveRouting(project, &buffer);
+    if ( buffer.data == NULL )
+    {
+        report_writeErrorMsg(project, ERR_MEMORY, "");
+        return FALSE;
+    }
+    queueCheckpoint(project, buffer.data, buffer.size);
+    return TRUE;
+}
+
+//=============================================================================
+
+void writeState(TStateBuffer* buffer, const void* x, size_t size, size_t count)
+//
+//  Input:   buffer = image of a hot start file
+//           x = values to write
+//           size = size of each value (bytes)
+//           count = number of values
+//  Output:  none
+//  Purpose: appends values to the image of a hot start file.
+//
+{
+    size_t n = size * count;
+    size_t capacity;
+    char*  data;
+
+    if ( buffer->capacity == (size_t)-1 ) return;
+    if ( buffer->size + n > buffer->capacity )
+    {
+        capacity = MAX(2 * buffer->capacity, buffer->size + n);
+        capacity = MAX(capacity, 4096);
+        data = (char *) realloc(buffer->data, capacity);
+
+        // --- a failed allocation leaves no image to save
+        if ( data == NULL )
+        {
+            free(buffer->data);
+            buffer->data = NULL;
+            buffer->capacity = (size_t)-1;
+            return;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+    memcpy(buffer->data + buffer->size, x, n);
+    buffer->size += n;
+}
+
+//=============================================================================
+
+void  saveRouting(Project *project, TStateBuffer* buffer)
+//
+//  Input:   buffer = image of a hot start file
 //  Output:  none
 //  Purpose: saves current state of all nodes and links to hotstart file.
 //
 {
-    int   i, j;
-    float x[3];
+    int    i, j;
+    double x[3];
 
     for (i = 0; i < project->Nobjects[NODE]; i++)
     {
-        x[0] = (float)project->Node[i].newDepth;
-        x[1] = (float)project->Node[i].newLatFlow;
-        fwrite(x, sizeof(float), 2, project->Fhotstart2.file);
+        x[0] = project->Node[i].newDepth;
+        x[1] = project->Node[i].newLatFlow;
+        writeState(buffer, x, sizeof(double), 2);
 
 ////  New code added to release 5.1.008.  ////                                 //(5.1.008)
         if ( project->Node[i].type == STORAGE )
         {
             j = project->Node[i].subIndex;
-            x[0] = (float)project->Storage[j].hrt;
-            fwrite(&x[0], sizeof(float), 1, project->Fhotstart2.file);
+            x[0] = project->Storage[j].hrt;
+            writeState(buffer, &x[0], sizeof(double), 1);
         }
 ////
 
         for (j = 0; j < project->Nobjects[POLLUT]; j++)
         {
-            x[0] = (float)project->Node[i].newQual[j];
-            fwrite(&x[0], sizeof(float), 1, project->Fhotstart2.file);
+            x[0] = project->Node[i].newQual[j];
+            writeState(buffer, &x[0], sizeof(double), 1);
         }
     }
     for (i = 0; i < project->Nobjects[LINK]; i++)
     {
-        x[0] = (float)project->Link[i].newFlow;
-        x[1] = (float)project->Link[i].newDepth;
-        x[2] = (float)project->Link[i].setting;
-        fwrite(x, sizeof(float), 3, project->Fhotstart2.file);
+        x[0] = project->Link[i].newFlow;
+        x[1] = project->Link[i].newDepth;
+        x[2] = project->Link[i].setting;
+        writeState(buffer, x, sizeof(double), 3);
         for (j = 0; j < project->Nobjects[POLLUT]; j++)
         {
-            x[0] = (float)project->Link[i].newQual[j];
-            fwrite(&x[0], sizeof(float), 1, project->Fhotstart2.file);
+            x[0] = project->Link[i].newQual[j];
+            writeState(buffer, &x[0], sizeof(double), 1);
         }
     }
 }
@@ -304,6 +470,7 @@ void readRouting(Project *project)
 {
     int   i, j;
     float x;
+    double y;
     double xgw[4];
     FILE* f = project->Fhotstart1.file;
 
@@ -329,24 +496,24 @@ void readRouting(Project *project)
     // --- read node states
     for (i = 0; i < project->Nobjects[NODE]; i++)
     {
-        if ( !readFloat(project, &x, f) ) return;
-        project->Node[i].newDepth = x;
-        if ( !readFloat(project, &x, f) ) return;
-        project->Node[i].newLatFlow = x;
+        if ( !readRoutingValue(project, &y, f) ) return;
+        project->Node[i].newDepth = y;
+        if ( !readRoutingValue(project, &y, f) ) return;
+        project->Node[i].newLatFlow = y;
 
 ////  New code added to release 5.1.008.  ////                                 //(5.1.008)
         if ( project->fileVersion >= 4 &&  project->Node[i].type == STORAGE )
         {
-            if ( !readFloat(project, &x, f) ) return;
+            if ( !readRoutingValue(project, &y, f) ) return;
             j = project->Node[i].subIndex;
-            project->Storage[j].hrt = x;
+            project->Storage[j].hrt = y;
         }
 ////
 
         for (j = 0; j < project->Nobjects[POLLUT]; j++)
         {
-            if ( !readFloat(project, &x, f) ) return;
-            project->Node[i].newQual[j] = x;
+            if ( !readRoutingValue(project, &y, f) ) return;
+            project->Node[i].newQual[j] = y;
         }
 
         // --- read in zeros here for backwards compatibility
@@ -354,7 +521,7 @@ void readRouting(Project *project)
         {
             for (j = 0; j < project->Nobjects[POLLUT]; j++)
             {
-                if ( !readFloat(project, &x, f) ) return;
+                if ( !readRoutingValue(project, &y, f) ) return;
             }
         }
     }
@@ -362,23 +529,23 @@ void readRouting(Project *project)
     // --- read link states
     for (i = 0; i < project->Nobjects[LINK]; i++)
     {
-        if ( !readFloat(project, &x, f) ) return;
-        project->Link[i].newFlow = x;
-        if ( !readFloat(project, &x, f) ) return;
-        project->Link[i].newDepth = x;
-        if ( !readFloat(project, &x, f) ) return;
-        project->Link[i].setting = x;
+        if ( !readRoutingValue(project, &y, f) ) return;
+        project->Link[i].newFlow = y;
+        if ( !readRoutingValue(project, &y, f) ) return;
+        project->Link[i].newDepth = y;
+        if ( !readRoutingValue(project, &y, f) ) return;
+        project->Link[i].setting = y;
 
 ////  Following code section moved to here.  ////                              //(5.1.011)
         // --- set link's target setting to saved setting 
-        project->Link[i].targetSetting = x;
+        project->Link[i].targetSetting = y;
         link_setTargetSetting(project, i);
         link_setSetting(project, i, 0.0);
 ////
         for (j = 0; j < project->Nobjects[POLLUT]; j++)
         {
-            if ( !readFloat(project, &x, f) ) return;
-            project->Link[i].newQual[j] = x;
+            if ( !readRoutingValue(project, &y, f) ) return;
+            project->Link[i].newQual[j] = y;
         }
 
     }
@@ -386,16 +553,15 @@ void readRouting(Project *project)
 
 //=============================================================================
 
-void  saveRunoff(Project *project)
+void  saveRunoff(Project *project, TStateBuffer* buffer)
 //
-//  Input:   none
+//  Input:   buffer = image of a hot start file
 //  Output:  none
 //  Purpose: saves current state of all subcatchments to hotstart file.
 //
 {
     int   i, j, k, sizeX;
     double* x;
-    FILE*  f = project->Fhotstart2.file;
 
     sizeX = MAX(6, project->Nobjects[POLLUT]+1);
     x = (double *) calloc(sizeX, sizeof(double));
@@ -405,18 +571,18 @@ void  saveRunoff(Project *project)
         // Ponded depths for each sub-area & total runoff (4 elements)
         for (j = 0; j < 3; j++) x[j] = project->Subcatch[i].subArea[j].depth;
         x[3] = project->Subcatch[i].newRunoff;
-        fwrite(x, sizeof(double), 4, f);
+        writeState(buffer, x, sizeof(double), 4);
 
         // Infiltration state (max. of 6 elements)
         for (j=0; j<sizeX; j++) x[j] = 0.0;
         infil_getState(project, i, project->InfilModel, x);
-        fwrite(x, sizeof(double), 6, f);
+        writeState(buffer, x, sizeof(double), 6);
 
         // Groundwater state (4 elements)
         if ( project->Subcatch[i].groundwater != NULL )
         {
             gwater_getState(project, i, x);
-            fwrite(x, sizeof(double), 4, f);
+            writeState(buffer, x, sizeof(double), 4);
         }
 
         // Snowpack state (5 elements for each of 3 snow surfaces)
@@ -425,7 +591,7 @@ void  saveRunoff(Project *project)
             for (j=0; j<3; j++)
             {
                 snow_getState(project, i, j, x);
-                fwrite(x, sizeof(double), 5, f);
+                writeState(buffer, x, sizeof(double), 5);
             }
         }
 
@@ -434,20 +600,20 @@ void  saveRunoff(Project *project)
         {
             // Runoff quality
             for (j=0; j<project->Nobjects[POLLUT]; j++) x[j] = project->Subcatch[i].newQual[j];
-            fwrite(x, sizeof(double), project->Nobjects[POLLUT], f);
+            writeState(buffer, x, sizeof(double), project->Nobjects[POLLUT]);
 
             // Ponded quality
             for (j=0; j<project->Nobjects[POLLUT]; j++) x[j] = project->Subcatch[i].pondedQual[j];
-            fwrite(x, sizeof(double), project->Nobjects[POLLUT], f);
+            writeState(buffer, x, sizeof(double), project->Nobjects[POLLUT]);
             
             // Buildup and when streets were last swept
             for (k=0; k<project->Nobjects[LANDUSE]; k++)
             {
                 for (j=0; j<project->Nobjects[POLLUT]; j++)
                     x[j] = project->Subcatch[i].landFactor[k].buildup[j];
-                fwrite(x, sizeof(double), project->Nobjects[POLLUT], f);
+                writeState(buffer, x, sizeof(double), project->Nobjects[POLLUT]);
                 x[0] = project->Subcatch[i].landFactor[k].lastSwept;
-                fwrite(x, sizeof(double), 1, f);
+                writeState(buffer, x, sizeof(double), 1);
             }
         }
     }
@@ -570,3 +736,21 @@ int  readDouble(Project *project, double* x, FILE* f)
     }
     return TRUE;
 }
+
+//=============================================================================
+
+int  readRoutingValue(Project *project, double* x, FILE* f)
+//
+//  Input:   none
+//  Output:  x  = pointer to a double variable
+//  Purpose: reads a node or link state from a hot start file, which version
+//           5 files save as a double and earlier versions as a float.
+//
+{
+    float y;
+
+    if ( project->fileVersion >= 5 ) return readDouble(project, x, f);
+    if ( !readFloat(project, &y, f) ) return FALSE;
+    *x = y;
+    return TRUE;
+}
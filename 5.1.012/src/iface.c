@@ -131,6 +131,18 @@ int iface_readFileParams(Project *project, char* tok[], int ntoks)
         project->Foutflows.mode = k;
         sstrncpy(project->Foutflows.name, tok[2], MAXFNAME);
         break;
+
+      case TRACE_FILE:
+        if ( k != SAVE_FILE ) return error_setInpError(ERR_ITEMS, "");
+        project->Ftrace.mode = k;
+        sstrncpy(project->Ftrace.name, tok[2], MAXFNAME);
+        break;
+
+      case HOTSPOTS_FILE:
+        if ( k != SAVE_FILE ) return error_setInpError(ERR_ITEMS, "");
+        project->Fhotspots.mode = k;
+        sstrncpy(project->Fhotspots.name, tok[2], MAXFNAME);
+        break;
     }
     return 0;
 }
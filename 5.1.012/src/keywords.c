@@ -69,7 +69,8 @@ char* EvapTypeWords[]      = { w_CONSTANT, w_MONTHLY, w_TIMESERIES,
                                w_TEMPERATURE, w_FILE, w_RECOVERY,
                                w_DRYONLY, NULL};
 char* FileTypeWords[]      = { w_RAINFALL, w_RUNOFF, w_HOTSTART, w_RDII,
-                               w_INFLOWS, w_OUTFLOWS, NULL};
+                               w_INFLOWS, w_OUTFLOWS, w_TRACE,
+                               w_HOTSPOTS, NULL};
 char* FileModeWords[]      = { w_NO, w_SCRATCH, w_USE, w_SAVE, NULL};
 char* FlowUnitWords[]      = { w_CFS, w_GPM, w_MGD, w_CMS, w_LPS, w_MLD, NULL};
 char* ForceMainEqnWords[]  = { w_H_W, w_D_W, NULL};
@@ -109,7 +110,11 @@ char* OptionWords[]        = { w_FLOW_UNITS,        w_INFIL_MODEL,
                                w_MAX_TRIALS,        w_HEAD_TOL,
                                w_SYS_FLOW_TOL,      w_LAT_FLOW_TOL,
                                w_IGNORE_RDII,       w_MIN_ROUTE_STEP,          //(5.1.008)
-                               w_NUM_THREADS,       NULL};                     //(5.1.008)
+                               w_NUM_THREADS,                                  //(5.1.008)
+                               w_SKIP_DRY_ELEMENTS,
+                               w_CHECKPOINT_INTERVAL, w_RESUME_HOTSTART,
+                               w_PERF_STATS,        w_PERF_COUNTERS,
+                               NULL};
 char* OrificeTypeWords[]   = { w_SIDE, w_BOTTOM, NULL};
 char* OutfallTypeWords[]   = { w_FREE, w_NORMAL, w_FIXED, w_TIDAL,
                                w_TIMESERIES, NULL};
@@ -181,6 +181,8 @@ struct LidGroup
 //  lid_delete               called by deleteObjects in project.c
 //  lid_validate             called by project_validate
 //  lid_initState            called by project_init
+//  lid_addStateRegions      called by findStateRegions in snapshot.c
+//  lid_detachRptFiles       called by snapshot_fork
 
 //  lid_readProcParams       called by parseLine in input.c
 //  lid_readGroupParams      called by parseLine in input.c
@@ -1140,6 +1142,57 @@ void validateLidGroup(Project *project, int j)
 
 //=============================================================================
 
+void lid_addStateRegions(Project *project)
+//
+//  Purpose: adds the state of each LID group & unit to a snapshot.
+//  Input:   none
+//  Output:  none
+//
+{
+    int j;
+    TLidList**  lidList;
+    TLidGroup   lidGroup;
+
+    snapshot_addRegion(project, &project->LidGroups, project->GroupCount * sizeof(TLidGroup));
+    for (j = 0; j < project->GroupCount; j++)
+    {
+        lidGroup = project->LidGroups[j];
+        if ( lidGroup == NULL ) continue;
+        snapshot_addRegion(project, &project->LidGroups[j], sizeof(struct LidGroup));
+        for (lidList = &lidGroup->lidList; *lidList; lidList = &(*lidList)->nextLidUnit)
+        {
+            snapshot_addRegion(project, lidList, sizeof(TLidList));
+            snapshot_addRegion(project, &(*lidList)->lidUnit, sizeof(TLidUnit));
+        }
+    }
+}
+
+//=============================================================================
+
+void lid_detachRptFiles(Project *project)
+//
+//  Purpose: stops a forked run from writing to its parent's LID report files.
+//  Input:   none
+//  Output:  none
+//
+{
+    int j;
+    TLidList*  lidList;
+    TLidGroup  lidGroup;
+
+    for (j = 0; j < project->GroupCount; j++)
+    {
+        lidGroup = project->LidGroups[j];
+        if ( lidGroup == NULL ) continue;
+        for (lidList = lidGroup->lidList; lidList; lidList = lidList->nextLidUnit)
+        {
+            lidList->lidUnit->rptFile = NULL;
+        }
+    }
+}
+
+//=============================================================================
+
 void lid_initState(Project *project)
 //
 //  Purpose: initializes the internal state of each LID in a subcatchment.
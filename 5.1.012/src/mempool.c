@@ -34,6 +34,7 @@
 //  AllocReset()    - reset the current pool
 //  AllocSetPool()  - set the current pool
 //  AllocFree()     - free the memory used by the current pool.
+//  AllocGetSize()  - find the memory used by the current pool.
 //-----------------------------------------------------------------------------
 
 
@@ -205,6 +206,26 @@ void  AllocReset(Project *project)
 }
 
 
+/*
+**  AllocGetSize()
+**
+**  Return the number of bytes of memory held by the current pool,
+**  including blocks kept for re-use after a reset.
+*/
+
+long  AllocGetSize(Project *project)
+{
+    alloc_hdr_t  *hdr;
+    long         size = sizeof(alloc_root_t);
+
+    for (hdr = project->root->first; hdr != NULL; hdr = hdr->next)
+    {
+        size += ALLOC_BLOCK_SIZE + sizeof(alloc_hdr_t);
+    }
+    return(size);
+}
+
+
 /*
 **  AllocFreePool()
 **
@@ -0,0 +1,459 @@
+/*!
+ * \file memuse.c
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+//-----------------------------------------------------------------------------
+//   memuse.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//
+//   Memory use of a project by subsystem.
+//
+//   swmm_getMemoryUse reports the bytes a project holds in each of the
+//   categories listed in MemoryUseType (see enums.h): the object arrays
+//   and the input data they own, the pollutant arrays of each object, the
+//   memory pool holding object IDs, the ID hash tables, time series and
+//   curve data points, RDII processing, runoff and routing work arrays,
+//   statistics, result buffers, diagnostics, snapshots, the coupling data
+//   cache (cached and exchanged values, rainfall grid, timestamped samples
+//   and state averages) and hot start checkpoint images waiting to be
+//   written.
+//
+//   Rather than tagging every allocation the totals are found by walking
+//   the project's data each time they are asked for, so keeping them costs
+//   nothing while a simulation runs and they can be retrieved at any point
+//   after a project is created. Sizes are those requested from the memory
+//   allocator, without its own overhead. The data points of control rule
+//   premises, transect tables and LID units are not included.
+//
+//   A forked run shares its parent's input data and holds its copy of the
+//   parent's state in a single block, which is reported as snapshot memory;
+//   its other categories only count the work arrays and coupling data
+//   cache it allocates itself.
+//
+//-----------------------------------------------------------------------------
+#include <stdlib.h>
+#include "headers.h"
+#include "hash.h"
+#include "mempool.h"
+#include "exfil.h"
+#include "lid.h"
+#include "dataexchangecache.h"
+#include "checkpointwriter.h"
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+//  memuse_getBytes          (called by swmm_getMemoryUse in swmm5.c)
+
+//-----------------------------------------------------------------------------
+//  Function declarations
+//-----------------------------------------------------------------------------
+static size_t getObjectBytes(Project *project);
+static size_t getInflowBytes(Project *project, int j);
+static size_t getQualityBytes(Project *project);
+static size_t getIdBytes(Project *project, int type);
+static size_t getTableBytes(TTable* tables, int count);
+static size_t getWorkBytes(Project *project);
+static size_t getStatsBytes(Project *project);
+static size_t getResultBytes(Project *project);
+static size_t getDiagnosticBytes(Project *project);
+static size_t getSnapshotBytes(Project *project);
+
+//=============================================================================
+
+double memuse_getBytes(Project *project, int type)
+//
+//  Input:   type = a MemoryUseType code
+//  Output:  returns number of bytes
+//  Purpose: finds the memory a project currently uses in a category.
+//
+{
+    // --- only the fields set when a project is created are valid until
+    //     one is opened
+    if ( !project->IsOpenFlag )
+    {
+        if ( type == MEM_DIAGNOSTICS ) return (double)getDiagnosticBytes(project);
+        if ( type == MEM_SNAPSHOTS )   return (double)getSnapshotBytes(project);
+        if ( type == MEM_COUPLING )    return (double)getCouplingDataCacheSize(project);
+        return 0.0;
+    }
+
+    // --- a fork's input data & state belong to its parent & its snapshot
+    if ( project->ForkParent )
+    {
+        switch ( type )
+        {
+          case MEM_OBJECTS:     return (double)sizeof(Project);
+          case MEM_ROUTING:     return (double)getWorkBytes(project);
+          case MEM_DIAGNOSTICS: return (double)getDiagnosticBytes(project);
+          case MEM_SNAPSHOTS:   return (double)getSnapshotBytes(project);
+          case MEM_COUPLING:    return (double)getCouplingDataCacheSize(project);
+          default:              return 0.0;
+        }
+    }
+
+    switch ( type )
+    {
+      case MEM_OBJECTS:     return (double)getObjectBytes(project);
+      case MEM_QUALITY:     return (double)getQualityBytes(project);
+      case MEM_ID_NAMES:    return (double)getIdBytes(project, MEM_ID_NAMES);
+      case MEM_HASH_TABLES: return (double)getIdBytes(project, MEM_HASH_TABLES);
+      case MEM_TABLES:
+        return (double)(getTableBytes(project->Tseries, project->Nobjects[TSERIES]) +
+                        getTableBytes(project->Curve, project->Nobjects[CURVE]));
+      case MEM_RDII:        return (double)rdii_getMemoryUse(project);
+      case MEM_ROUTING:     return (double)getWorkBytes(project);
+      case MEM_STATISTICS:  return (double)getStatsBytes(project);
+      case MEM_RESULTS:     return (double)getResultBytes(project);
+      case MEM_DIAGNOSTICS: return (double)getDiagnosticBytes(project);
+      case MEM_SNAPSHOTS:   return (double)getSnapshotBytes(project);
+      case MEM_COUPLING:    return (double)getCouplingDataCacheSize(project);
+      case MEM_CHECKPOINTS: return (double)getCheckpointWriterSize(project);
+    }
+    return 0.0;
+}
+
+//=============================================================================
+
+size_t getObjectBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by the project structure, the object
+//           arrays and the hydrologic & hydraulic data each object owns.
+//
+{
+    int    j;
+    int    nSubcatch = project->Nobjects[SUBCATCH];
+    size_t size = sizeof(Project);
+    TExfil* exfil;
+
+    size += project->Nobjects[GAGE] * sizeof(TGage);
+    size += nSubcatch * sizeof(TSubcatch);
+    size += project->Nobjects[NODE] * sizeof(TNode);
+    size += project->Nnodes[OUTFALL] * sizeof(TOutfall);
+    size += project->Nnodes[DIVIDER] * sizeof(TDivider);
+    size += project->Nnodes[STORAGE] * sizeof(TStorage);
+    size += project->Nobjects[LINK] * sizeof(TLink);
+    size += project->Nlinks[CONDUIT] * sizeof(TConduit);
+    size += project->Nlinks[PUMP] * sizeof(TPump);
+    size += project->Nlinks[ORIFICE] * sizeof(TOrifice);
+    size += project->Nlinks[WEIR] * sizeof(TWeir);
+    size += project->Nlinks[OUTLET] * sizeof(TOutlet);
+    size += project->Nobjects[POLLUT] * sizeof(TPollut);
+    size += project->Nobjects[LANDUSE] * sizeof(TLanduse);
+    size += project->Nobjects[TIMEPATTERN] * sizeof(TPattern);
+    size += project->Nobjects[CURVE] * sizeof(TTable);
+    size += project->Nobjects[TSERIES] * sizeof(TTable);
+    size += project->Nobjects[AQUIFER] * sizeof(TAquifer);
+    size += project->Nobjects[UNITHYD] * sizeof(TUnitHyd);
+    size += project->Nobjects[SNOWMELT] * sizeof(TSnowmelt);
+    size += project->Nobjects[SHAPE] * sizeof(TShape);
+    if ( project->Event ) size += (project->NumEvents + 1) * sizeof(TEvent);
+    if ( project->Transect ) size += project->Ntransects * sizeof(TTransect);
+    if ( project->Rules ) size += project->RuleCount * sizeof(TRule);
+    if ( project->LidProcs ) size += project->LidCount * sizeof(TLidProc);
+    if ( project->LidGroups ) size += project->GroupCount * sizeof(TLidGroup);
+
+    // --- infiltration, groundwater & snow pack data of subcatchments
+    if ( project->HortInfil ) size += nSubcatch * sizeof(THorton);
+    if ( project->GAInfil )   size += nSubcatch * sizeof(TGrnAmpt);
+    if ( project->CNInfil )   size += nSubcatch * sizeof(TCurveNum);
+    for (j = 0; project->Subcatch && j < nSubcatch; j++)
+    {
+        if ( project->Subcatch[j].groundwater ) size += sizeof(TGroundwater);
+        if ( project->Subcatch[j].snowpack ) size += sizeof(TSnowpack);
+        if ( project->Subcatch[j].landFactor )
+            size += project->Nobjects[LANDUSE] * sizeof(TLandFactor);
+    }
+
+    // --- land use buildup & washoff functions
+    for (j = 0; project->Landuse && j < project->Nobjects[LANDUSE]; j++)
+    {
+        if ( project->Landuse[j].buildupFunc )
+            size += project->Nobjects[POLLUT] * sizeof(TBuildup);
+        if ( project->Landuse[j].washoffFunc )
+            size += project->Nobjects[POLLUT] * sizeof(TWashoff);
+    }
+
+    // --- node inflows & treatment, storage unit exfiltration
+    for (j = 0; project->Node && j < project->Nobjects[NODE]; j++)
+    {
+        size += getInflowBytes(project, j);
+    }
+    for (j = 0; project->Storage && j < project->Nnodes[STORAGE]; j++)
+    {
+        exfil = project->Storage[j].exfil;
+        if ( exfil == NULL ) continue;
+        size += sizeof(TExfil);
+        if ( exfil->btmExfil ) size += sizeof(TGrnAmpt);
+        if ( exfil->bankExfil ) size += sizeof(TGrnAmpt);
+    }
+    return size;
+}
+
+//=============================================================================
+
+size_t getInflowBytes(Project *project, int j)
+//
+//  Input:   j = node index
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by a node's inflow & treatment data.
+//
+{
+    size_t size = 0;
+    TExtInflow* extInflow;
+    TDwfInflow* dwfInflow;
+
+    for (extInflow = project->Node[j].extInflow; extInflow; extInflow = extInflow->next)
+        size += sizeof(TExtInflow);
+    for (dwfInflow = project->Node[j].dwfInflow; dwfInflow; dwfInflow = dwfInflow->next)
+        size += sizeof(TDwfInflow);
+    if ( project->Node[j].rdiiInflow ) size += sizeof(TRdiiInflow);
+    if ( project->Node[j].treatment )
+        size += project->Nobjects[POLLUT] * sizeof(TTreatment);
+    return size;
+}
+
+//=============================================================================
+
+size_t getQualityBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by the pollutant arrays of subcatchments,
+//           nodes and links.
+//
+{
+    int    j;
+    size_t n = project->Nobjects[POLLUT] * sizeof(double);
+    size_t size = 0;
+
+    // --- initial buildup, old, new & ponded quality and total load
+    //     of subcatchments plus buildup on each of their land uses
+    if ( project->Subcatch )
+    {
+        size += project->Nobjects[SUBCATCH] * 5 * n;
+        for (j = 0; j < project->Nobjects[SUBCATCH]; j++)
+        {
+            if ( project->Subcatch[j].landFactor )
+                size += project->Nobjects[LANDUSE] * n;
+        }
+    }
+
+    // --- old & new quality of nodes, load routed from outfalls
+    if ( project->Node ) size += project->Nobjects[NODE] * 2 * n;
+    for (j = 0; project->Outfall && j < project->Nnodes[OUTFALL]; j++)
+    {
+        if ( project->Outfall[j].wRouted ) size += n;
+    }
+
+    // --- old & new quality and total load of links
+    if ( project->Link ) size += project->Nobjects[LINK] * 3 * n;
+    return size;
+}
+
+//=============================================================================
+
+size_t getIdBytes(Project *project, int type)
+//
+//  Input:   type = MEM_ID_NAMES or MEM_HASH_TABLES
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used to store & look up object ID names.
+//
+{
+    int    j;
+    size_t size = 0;
+
+    if ( type == MEM_ID_NAMES )
+    {
+        if ( project->MemPoolAllocated ) size = AllocGetSize(project);
+        return size;
+    }
+    for (j = 0; j < MAX_OBJ_TYPES; j++)
+    {
+        if ( project->Htable[j] ) size += HTsize(project->Htable[j]);
+    }
+    return size;
+}
+
+//=============================================================================
+
+size_t getTableBytes(TTable* tables, int count)
+//
+//  Input:   tables = array of time series or curves
+//           count = number of tables
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by the data points of a set of tables.
+//
+{
+    int    j;
+    size_t size = 0;
+    TTableEntry* entry;
+
+    for (j = 0; tables && j < count; j++)
+    {
+        for (entry = tables[j].firstEntry; entry; entry = entry->next)
+            size += sizeof(TTableEntry);
+    }
+    return size;
+}
+
+//=============================================================================
+
+size_t getWorkBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by the work arrays of runoff, treatment
+//           and flow routing.
+//
+{
+    int    nNodes = project->Nobjects[NODE];
+    int    nLinks = project->Nobjects[LINK];
+    int    nPollut = project->Nobjects[POLLUT];
+    size_t size = 0;
+
+    // --- arrays a fork allocates for itself
+    size += 10 * project->nmax * sizeof(double);
+    if ( project->OutflowLoad ) size += nPollut * sizeof(double);
+    if ( project->R ) size += 2 * nPollut * sizeof(double);
+    if ( project->LinkCost )
+    {
+        size += (nLinks + nNodes + 2) * sizeof(double);
+        size += 2 * (MAX(project->NumThreads, 1) + 1) * sizeof(int);
+    }
+    if ( project->ForkParent ) return size;
+
+    // --- dynamic wave node data, active element lists & routing order
+    if ( project->Xnode )
+    {
+        size += nNodes * sizeof(TXnode);
+        size += (nNodes + nLinks) * sizeof(int);                // active lists
+        size += (nNodes + 1 + 2 * nLinks + 1) * sizeof(int);    // links of nodes
+        size += (nNodes + 1 + 2 * (nLinks + 1)) * sizeof(int);  // routing order
+    }
+    if ( project->SortedLinks ) size += nLinks * sizeof(int);
+
+    // --- routing interface file values
+    if ( project->IfaceNodes )
+    {
+        size += project->NumIfaceNodes * sizeof(int);
+        size += project->NumIfacePolluts * sizeof(int);
+        size += 2 * project->NumIfaceNodes *
+                (sizeof(double *) + (1 + project->NumIfacePolluts) * sizeof(double));
+    }
+    return size;
+}
+
+//=============================================================================
+
+size_t getStatsBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by summary and mass balance statistics.
+//
+{
+    int    j;
+    int    nPollut = project->Nobjects[POLLUT];
+    size_t size = 0;
+
+    if ( project->SubcatchStats )
+        size += project->Nobjects[SUBCATCH] * sizeof(TSubcatchStats);
+    if ( project->NodeStats ) size += project->Nobjects[NODE] * sizeof(TNodeStats);
+    if ( project->LinkStats ) size += project->Nobjects[LINK] * sizeof(TLinkStats);
+    if ( project->StorageStats )
+        size += project->Nnodes[STORAGE] * sizeof(TStorageStats);
+    if ( project->OutfallStats )
+    {
+        size += project->Nnodes[OUTFALL] * sizeof(TOutfallStats);
+        for (j = 0; j < project->Nnodes[OUTFALL]; j++)
+        {
+            if ( project->OutfallStats[j].totalLoad ) size += nPollut * sizeof(double);
+        }
+    }
+    if ( project->PumpStats ) size += project->Nlinks[PUMP] * sizeof(TPumpStats);
+    if ( project->NodeSolverStats )
+        size += project->Nobjects[NODE] * sizeof(TSolverStats);
+    if ( project->LinkSolverStats )
+        size += project->Nobjects[LINK] * sizeof(TSolverStats);
+
+    // --- mass balance totals
+    if ( project->LoadingTotals ) size += nPollut * sizeof(TLoadingTotals);
+    if ( project->QualTotals ) size += 2 * nPollut * sizeof(TRoutingTotals);
+    if ( project->NodeInflow ) size += project->Nobjects[NODE] * sizeof(double);
+    if ( project->NodeOutflow ) size += project->Nobjects[NODE] * sizeof(double);
+    return size;
+}
+
+//=============================================================================
+
+size_t getResultBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used to buffer results written to the binary
+//           output file.
+//
+{
+    size_t size = 0;
+
+    if ( project->SubcatchResults ) size += project->NsubcatchResults * sizeof(float);
+    if ( project->NodeResults ) size += project->NnodeResults * sizeof(float);
+    if ( project->LinkResults ) size += project->NlinkResults * sizeof(float);
+    return size;
+}
+
+//=============================================================================
+
+size_t getDiagnosticBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by the trace event buffer and CPU event
+//           counters.
+//
+{
+    size_t size = 0;
+
+    if ( project->Trace.events ) size += project->Trace.capacity * sizeof(TTraceEvent);
+    if ( project->ThreadCounters )
+        size += project->NumThreadCounters * sizeof(TThreadCounters);
+    return size;
+}
+
+//=============================================================================
+
+size_t getSnapshotBytes(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by the list of state regions and, for a
+//           forked run, its copy of its parent's state.
+//
+{
+    size_t size = 0;
+
+    if ( project->StateRegions ) size += project->MaxStateRegions * sizeof(TStateRegion);
+    if ( project->ForkState ) size += project->ForkStateSize;
+    return size;
+}
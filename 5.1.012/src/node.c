@@ -66,6 +66,7 @@ typedef struct
 {
     int     k;                  // storage unit index
     double  v;                  // storage unit volume (ft3)
+    int     evaluations;        // times volume function was evaluated
 } TStorageVol;
 
 //-----------------------------------------------------------------------------
@@ -810,9 +811,12 @@ double storage_getDepth(Project *project, int j, double v)
         {
             storageVol.k = k;
             storageVol.v = v;
+            storageVol.evaluations = 0;
             d = v / (project->Storage[k].aConst + project->Storage[k].aCoeff);
             findroot_Newton(project, 0.0, project->Node[j].fullDepth*UCF(project, LENGTH), &d,
                             0.001, storage_getVolDiff, &storageVol);            
+            if ( project->NodeSolverStats )
+                project->NodeSolverStats[j].rootEvaluations += storageVol.evaluations;
         }
         d /= UCF(project, LENGTH);
         if ( d > project->Node[j].fullDepth ) d = project->Node[j].fullDepth;
@@ -837,6 +841,7 @@ void  storage_getVolDiff(Project *project, double y, double* f, double* df, void
 		
     // ... cast void pointer p to a TStorageVol object
     storageVol = (TStorageVol *)p;
+    storageVol->evaluations++;
     k = storageVol->k;
 
     // ... find storage volume at depth y
@@ -0,0 +1,355 @@
+/*!
+ * \file perf.c
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+//-----------------------------------------------------------------------------
+//   perf.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//
+//   Timing of the phases of a simulation.
+//
+//   With the PERF_STATS option each major phase of a routing time step
+//   (runoff, control rules, lateral inflows, flow and quality routing,
+//   losses, flow statistics, saving results, etc.) accumulates the wall
+//   clock time it takes, the number of times it runs and, for phases that
+//   iterate, the number of iterations it uses. The totals are written to
+//   the report file and can be retrieved with swmm_getPerfStats. When the
+//   option is off each timer costs a single test of the option's flag.
+//   The same timers provide the spans recorded by trace.c.
+//
+//   With the PERF_COUNTERS option the CPU's hardware counters also count
+//   the cycles, instructions, cache misses and branch misses of runoff,
+//   dynamic wave link flows and node depths, quality routing and saving
+//   results, separately for each thread that works on them. Each thread
+//   opens its own group of counters with perf_event_open the first time
+//   it counts, so this is only available on Linux; elsewhere, or where
+//   the kernel does not allow it, the report notes that no counts were
+//   made.
+//
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "headers.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+//  hardware phase counted for each timed phase (-1 if none)
+static const int CountedPhases[MAX_PERF_PHASES] = {-1, COUNTED_RUNOFF, -1,
+    -1, -1, -1, COUNTED_QUALITY, -1, -1, COUNTED_OUTPUT, -1};
+
+#ifdef __linux__
+static const unsigned long long CounterEvents[MAX_PERF_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+static __thread long ThreadId = 0;           // id of calling thread (0 if unknown)
+#endif
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+//  perf_open                (called by swmm_start in swmm5.c)
+//  perf_start               (called by various simulation functions)
+//  perf_stop                (called by various simulation functions)
+//  perf_close               (called by swmm_end in swmm5.c)
+//  perf_startCount          (called by dynwave.c)
+//  perf_stopCount           (called by dynwave.c)
+
+//-----------------------------------------------------------------------------
+//  Function declarations
+//-----------------------------------------------------------------------------
+static void startCount(TThreadCounters* counters);
+static void stopCount(TThreadCounters* counters, int phase);
+static int  readCounters(TThreadCounters* counters, double* values);
+static void openCounters(TThreadCounters* counters);
+static void closeCounters(TThreadCounters* counters);
+
+//=============================================================================
+
+void perf_open(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: clears the phase timers at the start of a run.
+//
+{
+    int i, k;
+
+    memset(project->PerfTimers, 0, sizeof(project->PerfTimers));
+
+    // --- one set of counters for each thread routing may use
+    project->ThreadCounters = NULL;
+    project->NumThreadCounters = 0;
+    if ( !project->PerfCounters ) return;
+    project->NumThreadCounters = MAX(project->NumThreads, 1);
+    project->ThreadCounters = (TThreadCounters *) calloc(
+        project->NumThreadCounters, sizeof(TThreadCounters));
+    if ( project->ThreadCounters == NULL )
+    {
+        project->NumThreadCounters = 0;
+        report_writeErrorMsg(project, ERR_MEMORY, "");
+        return;
+    }
+    for (k = 0; k < project->NumThreadCounters; k++)
+    {
+        for (i = 0; i < MAX_PERF_COUNTERS; i++)
+            project->ThreadCounters[k].fd[i] = -1;
+        project->ThreadCounters[k].available = TRUE;
+    }
+}
+
+//=============================================================================
+
+void perf_close(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: closes and frees the hardware counters at the end of a run.
+//
+{
+    int k;
+
+    if ( project->ThreadCounters == NULL ) return;
+    for (k = 0; k < project->NumThreadCounters; k++)
+        closeCounters(&project->ThreadCounters[k]);
+    FREE(project->ThreadCounters);
+    project->NumThreadCounters = 0;
+}
+
+//=============================================================================
+
+void perf_start(Project *project, int phase)
+//
+//  Input:   phase = a PerfPhaseType code
+//  Output:  none
+//  Purpose: marks the start of a timed phase.
+//
+{
+    // --- timed phases run on the thread that leads the routing threads
+    if ( project->ThreadCounters && CountedPhases[phase] >= 0 )
+        startCount(&project->ThreadCounters[0]);
+    if ( !project->PerfStats && project->Trace.events == NULL ) return;
+    project->PerfTimers[phase].start = omp_get_wtime();
+}
+
+//=============================================================================
+
+void perf_stop(Project *project, int phase, int iterations)
+//
+//  Input:   phase = a PerfPhaseType code
+//           iterations = number of iterations made by the phase
+//  Output:  none
+//  Purpose: adds the time since perf_start was called to a phase's totals.
+//
+{
+    TPerfStats* timer;
+    double      now;
+
+    if ( project->ThreadCounters && CountedPhases[phase] >= 0 )
+        stopCount(&project->ThreadCounters[0], CountedPhases[phase]);
+    if ( !project->PerfStats && project->Trace.events == NULL ) return;
+    timer = &project->PerfTimers[phase];
+    now = omp_get_wtime();
+    if ( project->Trace.events )
+        trace_addSpan(project, phase, timer->start, now, iterations);
+    if ( !project->PerfStats ) return;
+    timer->time += now - timer->start;
+    timer->calls++;
+    timer->iterations += iterations;
+}
+
+//=============================================================================
+
+void perf_startCount(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: marks the start of a phase worked on by the calling thread of
+//           the routing threads; the phase is named when it stops.
+//
+{
+    int k;
+
+    if ( project->ThreadCounters == NULL ) return;
+    k = omp_get_thread_num();
+    if ( k < project->NumThreadCounters ) startCount(&project->ThreadCounters[k]);
+}
+
+//=============================================================================
+
+void perf_stopCount(Project *project, int phase)
+//
+//  Input:   phase = a CountedPhaseType code
+//  Output:  none
+//  Purpose: adds the events counted by the calling thread of the routing
+//           threads since perf_startCount was called to a phase's totals.
+//
+{
+    int k;
+
+    if ( project->ThreadCounters == NULL ) return;
+    k = omp_get_thread_num();
+    if ( k < project->NumThreadCounters ) stopCount(&project->ThreadCounters[k], phase);
+}
+
+//=============================================================================
+
+void startCount(TThreadCounters* counters)
+//
+//  Input:   counters = the calling thread's counters
+//  Output:  none
+//  Purpose: saves the counts at the start of a phase.
+//
+{
+    readCounters(counters, counters->start);
+}
+
+//=============================================================================
+
+void stopCount(TThreadCounters* counters, int phase)
+//
+//  Input:   counters = the calling thread's counters
+//           phase = a CountedPhaseType code
+//  Output:  none
+//  Purpose: adds the events counted since startCount was called to a
+//           phase's totals.
+//
+{
+    int    i;
+    double values[MAX_PERF_COUNTERS];
+
+    if ( !readCounters(counters, values) ) return;
+    for (i = 0; i < MAX_PERF_COUNTERS; i++)
+        counters->count[phase][i] += values[i] - counters->start[i];
+}
+
+//=============================================================================
+
+int readCounters(TThreadCounters* counters, double* values)
+//
+//  Input:   counters = a thread's counters
+//  Output:  values = current counts (scaled for time not counted);
+//           returns TRUE if the counts could be read
+//  Purpose: reads the hardware counters of the calling thread.
+//
+{
+#ifdef __linux__
+    int i;
+    unsigned long long data[3 + MAX_PERF_COUNTERS];
+
+    // --- open counters on first use or if the thread number is now
+    //     served by a different thread
+    if ( ThreadId == 0 ) ThreadId = (long)syscall(SYS_gettid);
+    if ( counters->tid != ThreadId )
+    {
+        if ( !counters->available ) return FALSE;
+        closeCounters(counters);
+        openCounters(counters);
+        if ( !counters->available ) return FALSE;
+        counters->tid = ThreadId;
+    }
+
+    // --- data holds the number of counters, the time they were enabled
+    //     and the time they were counting, followed by their values
+    if ( read(counters->fd[0], data, sizeof(data)) != sizeof(data) ) return FALSE;
+    for (i = 0; i < MAX_PERF_COUNTERS; i++)
+    {
+        values[i] = (double)data[3+i];
+        if ( data[2] > 0 && data[2] < data[1] )
+            values[i] *= (double)data[1] / (double)data[2];
+    }
+    return TRUE;
+#else
+    counters->available = FALSE;
+    return FALSE;
+#endif
+}
+
+//=============================================================================
+
+void openCounters(TThreadCounters* counters)
+//
+//  Input:   counters = a thread's counters
+//  Output:  none
+//  Purpose: opens a group of hardware counters for the calling thread.
+//
+{
+#ifdef __linux__
+    int i;
+    struct perf_event_attr attr;
+
+    for (i = 0; i < MAX_PERF_COUNTERS; i++)
+    {
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = CounterEvents[i];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        counters->fd[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                                       i == 0 ? -1 : counters->fd[0], 0);
+        if ( counters->fd[i] < 0 )
+        {
+            closeCounters(counters);
+            counters->available = FALSE;
+            return;
+        }
+    }
+#else
+    counters->available = FALSE;
+#endif
+}
+
+//=============================================================================
+
+void closeCounters(TThreadCounters* counters)
+//
+//  Input:   counters = a thread's counters
+//  Output:  none
+//  Purpose: closes a thread's hardware counters.
+//
+{
+    int i;
+
+    for (i = MAX_PERF_COUNTERS - 1; i >= 0; i--)
+    {
+#ifdef __linux__
+        if ( counters->fd[i] >= 0 ) close(counters->fd[i]);
+#endif
+        counters->fd[i] = -1;
+    }
+    counters->tid = 0;
+}
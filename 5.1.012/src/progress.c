@@ -0,0 +1,118 @@
+/*!
+ * \file progress.c
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+//-----------------------------------------------------------------------------
+//   progress.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//
+//   Progress reporting through a callback.
+//
+//   A program running many projects at once registers a callback with
+//   swmm_setProgressCallback rather than watching the console. swmm_step
+//   calls it, on the thread that called swmm_step, once the given wall
+//   clock interval has passed since its last call (every step if the
+//   interval is 0) and always after the last step of a run. Each call
+//   reports the simulated and wall clock time, the current routing step,
+//   the average iterations per step, the routing steps made per second
+//   since the last call and the number of steps that failed to converge,
+//   which is enough to balance runs between workers and to notice one
+//   that has stalled. Without a callback each step costs a single test.
+//
+//   The callback stays registered across runs and restored states; a
+//   forked run starts without one.
+//
+//-----------------------------------------------------------------------------
+#include <omp.h>
+#include "headers.h"
+#include "swmm5.h"
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+//  progress_open            (called by swmm_start in swmm5.c)
+//  progress_update          (called by swmm_step in swmm5.c)
+
+//=============================================================================
+
+void progress_open(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: starts the wall clock of a run.
+//
+{
+    TProgress* progress = &project->Progress;
+
+    progress->startTime = omp_get_wtime();
+    progress->lastTime = progress->startTime;
+    progress->lastSteps = 0;
+}
+
+//=============================================================================
+
+void progress_update(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: passes the progress of a run to the progress callback when
+//           its interval has passed or the run is complete.
+//
+{
+    TProgress* progress = &project->Progress;
+    SWMM_ProgressInfo info;
+    double now, eventSteps;
+    int    finished;
+
+    if ( progress->callback == NULL ) return;
+    now = omp_get_wtime();
+    finished = project->NewRoutingTime >= project->TotalDuration;
+    if ( !finished && now - progress->lastTime < progress->interval ) return;
+
+    // --- a restored state can set the step count back
+    if ( project->StepCount < progress->lastSteps )
+        progress->lastSteps = project->StepCount;
+
+    info.simulatedTime = project->NewRoutingTime / MSECperDAY;
+    info.totalTime = project->TotalDuration / MSECperDAY;
+    info.wallTime = now - progress->startTime;
+    info.routingStep = (project->NewRoutingTime - project->OldRoutingTime) / 1000.0;
+    info.steps = project->StepCount;
+    info.nonConvergeCount = project->NonConvergeCount;
+
+    // --- iterations are only counted for steps not in steady state
+    //     (see report_writeSysStats)
+    info.avgIterations = 0.0;
+    eventSteps = (double)project->StepCount - project->SysStats.steadyStateCount;
+    if ( project->DoRouting && eventSteps > 0.0 )
+        info.avgIterations = project->SysStats.avgStepCount / eventSteps;
+
+    info.stepsPerSecond = 0.0;
+    if ( now > progress->lastTime )
+        info.stepsPerSecond = (project->StepCount - progress->lastSteps) /
+                              (now - progress->lastTime);
+
+    progress->lastTime = now;
+    progress->lastSteps = project->StepCount;
+    ((SWMM_ProgressCallback)progress->callback)(project, &info, progress->userData);
+}
+
+//=============================================================================
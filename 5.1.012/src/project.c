@@ -157,6 +157,9 @@ void project_readInput(Project *project)
    input_readData(project);
   if ( project->ErrorCode ) return;
 
+  // --- a resumed run starts when its hot start file was saved
+  if ( project->ResumeHotstart && !hotstart_resume(project) ) return;
+
   // --- establish starting & ending date/time
   project->StartDateTime = project->StartDate + project->StartTime;
   project->EndDateTime   = project->EndDate + project->EndTime;
@@ -587,6 +590,10 @@ int project_readOption(Project *project, char* s1, char* s2)
     case IGNORE_ROUTING:
     case IGNORE_QUALITY:
     case IGNORE_RDII:                                                        //(5.1.004)
+    case SKIP_DRY_ELEMENTS:
+    case RESUME_HOTSTART:
+    case PERF_STATS:
+    case PERF_COUNTERS:
       m = findmatch(s2, NoYesWords);
       if ( m < 0 ) return error_setInpError(ERR_KEYWORD, s2);
       switch ( k )
@@ -600,7 +607,20 @@ int project_readOption(Project *project, char* s1, char* s2)
         case IGNORE_ROUTING:    project->IgnoreRouting   = m;  break;
         case IGNORE_QUALITY:    project->IgnoreQuality   = m;  break;
         case IGNORE_RDII:       project->IgnoreRDII      = m;  break;                 //(5.1.004)
+        case SKIP_DRY_ELEMENTS: project->SkipDryElements = m;  break;
+        case RESUME_HOTSTART:   project->ResumeHotstart  = m;  break;
+        case PERF_STATS:        project->PerfStats       = m;  break;
+        case PERF_COUNTERS:     project->PerfCounters    = m;  break;
+      }
+      break;
+
+      // --- time between hot start file checkpoints (hours)
+    case CHECKPOINT_INTERVAL:
+      if ( !getDouble(s2, &tStep) || tStep < 0.0 )
+      {
+        return error_setInpError(ERR_NUMBER, s2);
       }
+      project->CheckpointStep = tStep * 3600.0;
       break;
 
     case NORMAL_FLOW_LTD:
@@ -668,6 +688,12 @@ int project_readOption(Project *project, char* s1, char* s2)
       break;
 
     case NUM_THREADS:
+      project->AutoThreads = match(s2, w_AUTO);
+      if ( project->AutoThreads )
+      {
+          project->NumThreads = 0;
+          break;
+      }
       m = atoi(s2);
       if ( m < 0 ) return error_setInpError(ERR_NUMBER, s2);
       project->NumThreads = m;
@@ -749,6 +775,8 @@ void initPointers(Project *project)
 //  Purpose: assigns NULL to all dynamic arrays for a new project.
 //
 {
+  int j;
+
   project->Gage     = NULL;
   project->Subcatch = NULL;
   project->Node     = NULL;
@@ -786,7 +814,44 @@ void initPointers(Project *project)
   project->GroupCount = 0;
   project->LidGroups = NULL;
   project->LidProcs = NULL;
-
+  for (j = 0; j < MAX_OBJ_TYPES; j++) project->Htable[j] = NULL;
+
+  // --- arrays allocated when a run starts (their memory use can be
+  //     queried before one does)
+  project->Xnode = NULL;
+  project->ActiveNodes = NULL;
+  project->ActiveLinks = NULL;
+  project->NodeLinkStart = NULL;
+  project->NodeLinkList = NULL;
+  project->NonConduitLinks = NULL;
+  project->LinkCost = NULL;
+  project->NodeCost = NULL;
+  project->LinkWorkStart = NULL;
+  project->NodeWorkStart = NULL;
+  project->SortedLinks = NULL;
+  project->IfacePolluts = NULL;
+  project->IfaceNodes = NULL;
+  project->R = NULL;
+  project->Cin = NULL;
+  project->OutflowLoad = NULL;
+  project->nmax = 0;
+  project->UHGroup = NULL;
+  project->RdiiNodeIndex = NULL;
+  project->RdiiNodeFlow = NULL;
+  project->SubcatchStats = NULL;
+  project->NodeStats = NULL;
+  project->LinkStats = NULL;
+  project->StorageStats = NULL;
+  project->OutfallStats = NULL;
+  project->PumpStats = NULL;
+  project->LoadingTotals = NULL;
+  project->QualTotals = NULL;
+  project->StepQualTotals = NULL;
+  project->NodeInflow = NULL;
+  project->NodeOutflow = NULL;
+  project->SubcatchResults = NULL;
+  project->NodeResults = NULL;
+  project->LinkResults = NULL;
 }
 
 //=============================================================================
@@ -816,6 +881,8 @@ void setDefaults(Project *project)
   project->Fhotstart2.mode = NO_FILE;
   project->Finflows.mode   = NO_FILE;
   project->Foutflows.mode  = NO_FILE;
+  project->Ftrace.mode     = NO_FILE;
+  project->Fhotspots.mode  = NO_FILE;
   project->Frain.file      = NULL;
   project->Fclimate.file   = NULL;
   project->Frunoff.file    = NULL;
@@ -824,6 +891,8 @@ void setDefaults(Project *project)
   project->Fhotstart2.file = NULL;
   project->Finflows.file   = NULL;
   project->Foutflows.file  = NULL;
+  project->Ftrace.file     = NULL;
+  project->Fhotspots.file  = NULL;
   project->Fout.file       = NULL;
   project->Fout.mode       = NO_FILE;
 
@@ -842,6 +911,11 @@ void setDefaults(Project *project)
   project->MinSurfArea     = 0.0;              // Force use of default min. surface area
   project->MinSlope        = 0.0;              // No user supplied minimum conduit slope //(5.1.012)
   project->SkipSteadyState = FALSE;            // Do flow routing in steady state periods
+  project->SkipDryElements = FALSE;            // Route all nodes & links under DW
+  project->ResumeHotstart  = FALSE;            // Start run at its START_DATE
+  project->PerfStats       = FALSE;            // Don't time simulation phases
+  project->PerfCounters    = FALSE;            // Don't count CPU events
+  project->CheckpointStep  = 0.0;              // Save hot start file only at end
   project->IgnoreRainfall  = FALSE;            // Analyze rainfall/runoff
   project->IgnoreRDII      = FALSE;            // Analyze RDII                         //(5.1.004)
   project->IgnoreSnowmelt  = FALSE;            // Analyze snowmelt
@@ -859,6 +933,7 @@ void setDefaults(Project *project)
   project->SysFlowTol      = 0.05;             // System flow tolerance for steady state
   project->LatFlowTol      = 0.05;             // Lateral flow tolerance for steady state
   project->NumThreads      = 0;                // Number of parallel threads to use
+  project->AutoThreads     = FALSE;            // Tune number of threads at start
   project->NumEvents       = 0;                // Number of detailed routing events    //(5.1.011)
 
   // Deprecated options
@@ -70,8 +70,6 @@ const char   FileStamp[] = FILE_STAMP;
 //-----------------------------------------------------------------------------
 // Data Structures
 //-----------------------------------------------------------------------------
-enum FileTypes {BINARY, TEXT};         // File mode types
-
 typedef struct                         // Data for a single unit hydrograph
 {                                      // -------------------------------------
    double*   pastRain;                 // array of past rainfall values
@@ -112,6 +110,7 @@ extern double     Qcf[];               // flow units conversion factors
 //  rdii_closeRdii          (called from rain_close)
 //  rdii_getNumRdiiFlows    (called from addRdiiInflows in routing.c)
 //  rdii_getRdiiFlow        (called from addRdiiInflows in routing.c)
+//  rdii_getMemoryUse       (called from memuse_getBytes in memuse.c)
 
 //-----------------------------------------------------------------------------
 // Function Declarations
@@ -563,6 +562,38 @@ void rdii_getRdiiFlow(Project *project, int i, int* j, double* q)
 
 //=============================================================================
 
+size_t rdii_getMemoryUse(Project *project)
+//
+//  Input:   none
+//  Output:  returns number of bytes
+//  Purpose: finds the memory used by RDII processing, including the past
+//           rainfall kept for each unit hydrograph while an RDII file is
+//           being created.
+//
+{
+    int    i, k;
+    size_t size = 0;
+
+    if ( project->UHGroup )
+    {
+        size += project->Nobjects[UNITHYD] * sizeof(TUHGroup);
+        for (i = 0; i < project->Nobjects[UNITHYD]; i++)
+        {
+            for (k = 0; k < 3; k++)
+            {
+                if ( project->UHGroup[i].uh[k].pastRain == NULL ) continue;
+                size += project->UHGroup[i].uh[k].maxPeriods *
+                        (sizeof(double) + sizeof(char));
+            }
+        }
+    }
+    if ( project->RdiiNodeIndex )
+        size += project->NumRdiiNodes * (sizeof(int) + sizeof(REAL4));
+    return size;
+}
+
+//=============================================================================
+
 int readRdiiFileHeader(Project *project)
 //
 //  Input:   none
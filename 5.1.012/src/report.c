@@ -99,6 +99,7 @@ static void report_Nodes(Project *project);
 static void report_NodeHeader(Project *project, char *id);
 static void report_Links(Project *project);
 static void report_LinkHeader(Project *project, char *id);
+static void report_EventCounts(Project *project, double* count);
 
 
 //=============================================================================
@@ -349,6 +350,9 @@ void report_writeOptions(Project *project)
     fprintf(project->Frpt.file, "\n  Antecedent Dry Days ...... %.1f", project->StartDryDays);
     datetime_timeToStr(datetime_encodeTime(0, 0, project->ReportStep), str);
     fprintf(project->Frpt.file, "\n  Report Time Step ......... %s", str);
+    if ( project->CheckpointStep > 0.0 )
+    fprintf(project->Frpt.file, "\n  Checkpoint Interval ...... %.2f hrs",
+        project->CheckpointStep / 3600.0);
     if ( project->Nobjects[SUBCATCH] > 0 )
     {
         datetime_timeToStr(datetime_encodeTime(0, 0, project->WetStep), str);
@@ -365,7 +369,12 @@ void report_writeOptions(Project *project)
 		if ( project->CourantFactor > 0.0 ) fprintf(project->Frpt.file, "YES");
 		else                       fprintf(project->Frpt.file, "NO");
 		fprintf(project->Frpt.file, "\n  Maximum Trials ........... %d", project->MaxTrials);
-	fprintf(project->Frpt.file, "\n  Number of Threads ........ %d", project->NumThreads);   //(5.1.008)
+		fprintf(project->Frpt.file, "\n  Skip Dry Elements ........ ");
+		if ( project->SkipDryElements ) fprintf(project->Frpt.file, "YES");
+		else                            fprintf(project->Frpt.file, "NO");
+		fprintf(project->Frpt.file, "\n  Number of Threads ........ ");
+		if ( project->AutoThreads ) fprintf(project->Frpt.file, "AUTO");
+		else fprintf(project->Frpt.file, "%d", project->NumThreads);   //(5.1.008)
 		fprintf(project->Frpt.file, "\n  Head Tolerance ........... %.6f ",
 	    project->HeadTol*UCF(project, LENGTH));                                              //(5.1.008)
 		if ( project->UnitSystem == US ) fprintf(project->Frpt.file, "ft");
@@ -1068,9 +1077,131 @@ void report_writeSysStats(Project *project, TSysStats* sysStats)
     fprintf(project->Frpt.file,
         "\n  Percent Not Converging      :  %7.2f",
         100.0 * (double)project->NonConvergeCount / eventStepCount);                    //(5.1.012)
+    if ( project->AutoThreads && project->RouteModel == DW )
+        fprintf(project->Frpt.file,
+            "\n  Number of Threads Used      :  %7d", project->NumThreads);
+    WRITE(project, "");
+}
+
+//=============================================================================
+
+void report_writePerfStats(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes time spent in each phase of the simulation to report file.
+//
+{
+    int    i;
+    double total = project->PerfTimers[PERF_STEP].time;
+    TPerfStats* timer;
+    static char* phaseNames[] = {"Total Step", "Runoff", "Routing",
+        "  Controls", "  Inflows", "  Flow Routing", "  Quality Routing",
+        "  Losses", "  Flow Statistics", "Saving Results", "Checkpoints"};
+
+    if ( project->Frpt.file == NULL || project->PerfTimers[PERF_STEP].calls == 0 )
+        return;
+    WRITE(project, "");
+    WRITE(project, "***********************");
+    WRITE(project, "Simulation Phase Timing");
+    WRITE(project, "***********************");
+    fprintf(project->Frpt.file,
+"\n  ------------------------------------------------------------------"
+"\n                          Total   Percent                   Average"
+"\n  Phase                 Time sec  of Steps        Calls    Iterations"
+"\n  ------------------------------------------------------------------");
+    for (i = 0; i < MAX_PERF_PHASES; i++)
+    {
+        timer = &project->PerfTimers[i];
+        if ( timer->calls == 0 ) continue;
+        fprintf(project->Frpt.file, "\n  %-20s %9.3f %9.2f %12ld",
+            phaseNames[i], timer->time,
+            total > 0.0 ? 100.0 * timer->time / total : 0.0, timer->calls);
+        if ( timer->iterations > 0 ) fprintf(project->Frpt.file, " %13.2f",
+            (double)timer->iterations / timer->calls);
+    }
+    WRITE(project, "");
+}
+
+
+//=============================================================================
+
+void report_writePerfCounters(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes hardware events counted in each phase of the simulation
+//           by each thread to report file.
+//
+{
+    int    i, k, n, threads;
+    double total[MAX_PERF_COUNTERS];
+    double* count;
+    static char* phaseNames[] = {"Runoff", "Link Flows", "Node Depths",
+        "Quality Routing", "Saving Results"};
+
+    if ( project->Frpt.file == NULL ) return;
+    WRITE(project, "");
+    WRITE(project, "********************************");
+    WRITE(project, "Simulation Phase Hardware Events");
+    WRITE(project, "********************************");
+
+    // --- counters exist only on Linux and only if the kernel allows it
+    for (k = 0; k < project->NumThreadCounters; k++)
+    {
+        if ( project->ThreadCounters[k].tid != 0 ) break;
+    }
+    if ( k == project->NumThreadCounters )
+    {
+        WRITE(project, "Hardware event counters are not available.");
+        WRITE(project, "");
+        return;
+    }
+
+    fprintf(project->Frpt.file,
+"\n  ------------------------------------------------------------------------------------------"
+"\n                                 Cycles   Instructions   Instr.  Cache Misses  Branch Misses"
+"\n  Phase              Thread       x10^6          x10^6   /Cycle         x10^6          x10^6"
+"\n  ------------------------------------------------------------------------------------------");
+    for (i = 0; i < MAX_COUNTED_PHASES; i++)
+    {
+        memset(total, 0, sizeof(total));
+        threads = 0;
+        for (k = 0; k < project->NumThreadCounters; k++)
+        {
+            count = project->ThreadCounters[k].count[i];
+            if ( count[CYCLES_COUNTER] <= 0.0 ) continue;
+            fprintf(project->Frpt.file, "\n  %-18s %6d", threads == 0 ?
+                phaseNames[i] : "", k);
+            report_EventCounts(project, count);
+            for (n = 0; n < MAX_PERF_COUNTERS; n++) total[n] += count[n];
+            threads++;
+        }
+        if ( threads > 1 )
+        {
+            fprintf(project->Frpt.file, "\n  %-18s %6s", "", "All");
+            report_EventCounts(project, total);
+        }
+    }
     WRITE(project, "");
 }
 
+//=============================================================================
+
+void report_EventCounts(Project *project, double* count)
+//
+//  Input:   count = number of each hardware event
+//  Output:  none
+//  Purpose: writes a line of hardware event counts to report file.
+//
+{
+    fprintf(project->Frpt.file, " %11.1f %14.1f %8.2f %13.2f %14.2f",
+        count[CYCLES_COUNTER] / 1.0e6, count[INSTRUCTIONS_COUNTER] / 1.0e6,
+        count[CYCLES_COUNTER] > 0.0 ?
+            count[INSTRUCTIONS_COUNTER] / count[CYCLES_COUNTER] : 0.0,
+        count[CACHE_MISSES_COUNTER] / 1.0e6, count[BRANCH_MISSES_COUNTER] / 1.0e6);
+}
+
 
 //=============================================================================
 //      SIMULATION RESULTS REPORTING
@@ -1461,7 +1592,7 @@ void report_writeWarningMsg(Project *project, char* msg, char* id)
 //  Purpose: writes a warning message to the report file.
 //
 {
-    fprintf(project->Frpt.file, "\n  %s %s", msg, id);
+    if ( project->Frpt.file ) fprintf(project->Frpt.file, "\n  %s %s", msg, id);
     project->Warnings++;                                                                //(5.1.011)
 }
 
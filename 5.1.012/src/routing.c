@@ -215,6 +215,7 @@ void routing_execute(Project *project, int routingModel, double routingStep)
 
     // --- find new link target settings that are not related to
     // --- control rules (e.g., pump on/off depth limits)
+    perf_start(project, PERF_CONTROLS);
     for (j=0; j<project->Nobjects[LINK]; j++) link_setTargetSetting(project, j);
 
     // --- find new target settings due to control rules
@@ -236,6 +237,8 @@ void routing_execute(Project *project, int routingModel, double routingStep)
             actionCount++;
         } 
     }
+    perf_stop(project, PERF_CONTROLS, 0);
+    if ( actionCount > 0 ) trace_addEvent(project, TRACE_CONTROL_ACTIONS, actionCount);
 
     // --- update value of elapsed routing time (in milliseconds)
     project->OldRoutingTime = project->NewRoutingTime;
@@ -277,6 +280,7 @@ void routing_execute(Project *project, int routingModel, double routingStep)
     if ( project->BetweenEvents == FALSE )
     {
         // --- find evap. & seepage losses from storage nodes
+        perf_start(project, PERF_INFLOWS);
         for (j = 0; j < project->Nobjects[NODE]; j++)
         {
             project->Node[j].losses = node_getLosses(project, j, routingStep);
@@ -293,6 +297,7 @@ void routing_execute(Project *project, int routingModel, double routingStep)
 
         // add coupling lateral inflows
         applyCouplingLateralInflows(project);
+        perf_stop(project, PERF_INFLOWS, 0);
 
         // --- check if can skip steady state periods based on flows
         if ( project->SkipSteadyState )
@@ -318,20 +323,26 @@ void routing_execute(Project *project, int routingModel, double routingStep)
             // --- route flow through the drainage network
             if ( project->Nobjects[LINK] > 0 )
             {
+                perf_start(project, PERF_FLOW_ROUTING);
                 stepCount = flowrout_execute(project, project->SortedLinks, routingModel, routingStep);
+                perf_stop(project, PERF_FLOW_ROUTING, stepCount);
             }
         }
 
         // --- route quality through the drainage network
         if ( project->Nobjects[POLLUT] > 0 && !project->IgnoreQuality )
         {
+            perf_start(project, PERF_QUAL_ROUTING);
             qualrout_execute(project, routingStep);
+            perf_stop(project, PERF_QUAL_ROUTING, 0);
         }
 
         // --- remove evaporation, infiltration & outflows from system
+        perf_start(project, PERF_LOSSES);
         removeStorageLosses(project, routingStep);
         removeConduitLosses(project);
         removeOutflows(project, routingStep);
+        perf_stop(project, PERF_LOSSES, 0);
     }
     else inSteadyState = TRUE;
 	
@@ -342,9 +353,14 @@ void routing_execute(Project *project, int routingModel, double routingStep)
     // --- update summary statistics
     if ( project->RptFlags.flowStats && project->Nobjects[LINK] > 0 )
     {
+        perf_start(project, PERF_FLOW_STATS);
         stats_updateFlowStats(project, routingStep, getDateTime(project, project->NewRoutingTime),
                               stepCount, inSteadyState);
+        perf_stop(project, PERF_FLOW_STATS, 0);
     }
+
+    // --- accumulate time-averaged states for coupled models
+    accumulateCouplingStates(project, routingStep);
 }
 
 //=============================================================================
@@ -64,6 +64,7 @@
 
 #include "headers.h"
 #include "odesolve.h"
+#include "dataexchangecache.h"
 
 
 
@@ -210,6 +211,7 @@ void runoff_execute(Project *project)
         gage_setState(project, j, currentDate);
         if ( project->Gage[j].rainfall > 0.0 ) project->IsRaining = TRUE;
     }
+    if ( isCouplingRaining(project) ) project->IsRaining = TRUE;
 
     // --- read runoff results from interface file if applicable
     if ( project->Frunoff.mode == USE_FILE )
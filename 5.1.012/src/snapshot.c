@@ -0,0 +1,855 @@
+/*!
+ * \file snapshot.c
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+//-----------------------------------------------------------------------------
+//   snapshot.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//
+//   In-memory state snapshot functions.
+//
+//   A snapshot holds a full precision copy of every block of memory that
+//   a running simulation changes: the Project structure itself, the object
+//   arrays, and the quality, groundwater, snow pack, infiltration, LID,
+//   control rule, mass balance and statistics data they point to. The
+//   blocks are listed once, the first time a snapshot is requested, so
+//   saving or restoring a state is just a series of memcpy calls. Because
+//   the blocks include pointers, a snapshot can only be restored into the
+//   run it was saved from.
+//
+//   The read positions of sequentially read input files (climate, RDII,
+//   routing interface and runoff interface files) are saved with the
+//   state. Files that are written to (report, binary output, hot start
+//   and saved interface files) are not rolled back, so runs that restore
+//   states would normally not save results to the binary output file.
+//
+//   The control rule action list is scratch space rebuilt on every rule
+//   evaluation, so a restore keeps the current list (whose items it
+//   owns) rather than the saved head. The coupling data cache is not part
+//   of the state either: a restore restarts any coupling state averages
+//   (see dataexchangecache.h) instead of rolling them back.
+//
+//   Each block also records where the pointer to it is stored (its owner),
+//   which always lies inside another block. This lets a running project be
+//   forked: a fork is a new Project whose state blocks are copied into one
+//   contiguous allocation, with each owner pointer redirected to the copy,
+//   while all input data that does not change during a run (object IDs,
+//   time series, curves, inflows, topology, etc.) remains shared with the
+//   parent. Forks have their own handles on the input files they read from,
+//   write no report, output, hot start, trace, hotspots or interface files,
+//   and start with an empty coupling data cache. A fork routes with the
+//   number of threads its parent was using and never tunes it. A parent
+//   must outlive its forks.
+//
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "headers.h"
+#include "lid.h"
+#include "odesolve.h"
+#include "dataexchangecache.h"
+
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+//  number of file members of a project, Finp through Fhotspots (globals.h)
+#define  NUM_PROJECT_FILES \
+    ((int)((offsetof(Project, Fhotspots) - offsetof(Project, Finp)) / sizeof(TFile) + 1))
+
+enum StateFileType {STATE_CLIMATE_FILE, STATE_RDII_FILE, STATE_INFLOWS_FILE,
+                    STATE_RUNOFF_FILE, MAX_STATE_FILES};
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct
+{
+    Project* project;                  // project the state was saved from
+    size_t   size;                     // size of state incl. header (bytes)
+    long     filePos[MAX_STATE_FILES]; // read positions of input files
+}   TStateHeader;
+
+typedef struct
+{
+    char*    data;                     // start of a parent's state block
+    size_t   size;                     // size of the block (bytes)
+    char*    copy;                     // start of the fork's copy of it
+}   TForkRegion;
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+//  snapshot_getSize      (called by swmm_getStateSize in swmm5.c)
+//  snapshot_save         (called by swmm_saveState in swmm5.c)
+//  snapshot_restore      (called by swmm_restoreState in swmm5.c)
+//  snapshot_addRegion    (called by lid_addStateRegions)
+//  snapshot_close        (called by swmm_end in swmm5.c)
+//  snapshot_fork         (called by swmm_fork in swmm5.c)
+//  snapshot_closeFork    (called by swmm_close in swmm5.c)
+
+//-----------------------------------------------------------------------------
+//  Function declarations
+//-----------------------------------------------------------------------------
+static void    findStateRegions(Project *project);
+static void    addObjectRegions(Project *project);
+static void    addQualityRegions(Project *project);
+static void    addResultRegions(Project *project);
+static TFile*  getStateFile(Project *project, int i);
+static void    addRegion(Project *project, void* data, void* owner, size_t size);
+static int     compareForkRegions(const void* a, const void* b);
+static char*   findForkCopy(TForkRegion* sorted, int n, char* p);
+static int     openForkFiles(Project *fork, Project *parent);
+static int     openForkFile(TFile* f, TFile* parentFile, char* mode);
+static int     allocForkWorkspace(Project *fork, Project *parent);
+
+//=============================================================================
+
+size_t snapshot_getSize(Project *project)
+//
+//  Input:   none
+//  Output:  returns size of a snapshot (bytes)
+//  Purpose: finds the number of bytes needed to hold the simulation's state.
+//
+{
+    if ( project->StateRegions == NULL ) findStateRegions(project);
+    return sizeof(TStateHeader) + project->StateSize;
+}
+
+//=============================================================================
+
+int snapshot_save(Project *project, char* state, size_t size)
+//
+//  Input:   state = buffer receiving the snapshot
+//           size = size of state buffer (bytes)
+//  Output:  returns TRUE if the snapshot was saved
+//  Purpose: copies the current simulation state into a buffer.
+//
+{
+    int     i;
+    TFile*  f;
+    TStateHeader header;
+
+    if ( size < snapshot_getSize(project) ) return FALSE;
+
+    header.project = project;
+    header.size = snapshot_getSize(project);
+    for (i = 0; i < MAX_STATE_FILES; i++)
+    {
+        f = getStateFile(project, i);
+        header.filePos[i] = f ? ftell(f->file) : 0;
+    }
+    memcpy(state, &header, sizeof(TStateHeader));
+    state += sizeof(TStateHeader);
+
+    for (i = 0; i < project->NumStateRegions; i++)
+    {
+        memcpy(state, project->StateRegions[i].data, project->StateRegions[i].size);
+        state += project->StateRegions[i].size;
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+int snapshot_restore(Project *project, const char* state, size_t size)
+//
+//  Input:   state = buffer holding a snapshot saved from this run
+//           size = size of state buffer (bytes)
+//  Output:  returns TRUE if the snapshot was restored
+//  Purpose: returns the simulation to a previously saved state.
+//
+{
+    int     i;
+    TFile*  f;
+    TFile   files[NUM_PROJECT_FILES];
+    TStateHeader header;
+
+    // --- these describe the open files & the run itself rather than
+    //     its state so they keep their current values
+    long    nperiods = project->Nperiods;
+    int     errorCode = project->ErrorCode;
+    int     warnings = project->Warnings;
+    int     exceptionCount = project->ExceptionCount;
+    time_t  sysTime = project->SysTime;
+    TStateRegion* regions = project->StateRegions;
+    int     numRegions = project->NumStateRegions;
+    int     maxRegions = project->MaxStateRegions;
+    size_t  stateSize = project->StateSize;
+    TPerfStats perfTimers[MAX_PERF_PHASES];
+    TTraceBuffer trace = project->Trace;
+    TProgress progress = project->Progress;
+    TThreadTuner tuner = project->ThreadTuner;
+    int     numThreads = project->NumThreads;
+    int     reservedThreads = project->ReservedThreads;
+    TActionList* actionList = project->ActionList;
+
+    if ( size < sizeof(TStateHeader) ) return FALSE;
+    memcpy(&header, state, sizeof(TStateHeader));
+    if ( header.project != project || header.size != snapshot_getSize(project)
+    ||   size < header.size ) return FALSE;
+
+    // --- files Finp through Fhotspots
+    memcpy(files, &project->Finp, sizeof(files));
+    memcpy(perfTimers, project->PerfTimers, sizeof(perfTimers));
+
+    state += sizeof(TStateHeader);
+    for (i = 0; i < numRegions; i++)
+    {
+        memcpy(regions[i].data, state, regions[i].size);
+        state += regions[i].size;
+    }
+
+    memcpy(&project->Finp, files, sizeof(files));
+    memcpy(project->PerfTimers, perfTimers, sizeof(perfTimers));
+    project->Trace = trace;
+    project->Progress = progress;
+    project->ActionList = actionList;
+    project->ThreadTuner = tuner;
+    project->NumThreads = numThreads;
+    project->ReservedThreads = reservedThreads;
+    project->Nperiods = nperiods;
+    project->ErrorCode = errorCode;
+    project->Warnings = warnings;
+    project->ExceptionCount = exceptionCount;
+    project->SysTime = sysTime;
+    project->StateRegions = regions;
+    project->NumStateRegions = numRegions;
+    project->MaxStateRegions = maxRegions;
+    project->StateSize = stateSize;
+
+    // --- thread work split was made for the active elements being replaced
+    project->WorkPartsChanged = TRUE;
+
+    // --- coupling state averages restart rather than keep rolled back steps
+    resetCouplingStateAverages(project);
+
+    for (i = 0; i < MAX_STATE_FILES; i++)
+    {
+        f = getStateFile(project, i);
+        if ( f ) fseek(f->file, header.filePos[i], SEEK_SET);
+    }
+    return TRUE;
+}
+
+//=============================================================================
+
+void snapshot_addRegion(Project *project, void* owner, size_t size)
+//
+//  Input:   owner = location of the pointer to a block of state data
+//           size = size of the block (bytes)
+//  Output:  none
+//  Purpose: adds a block of memory to those saved in a snapshot.
+//
+{
+    addRegion(project, *(void **)owner, owner, size);
+}
+
+//=============================================================================
+
+void snapshot_close(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the list of state regions at the end of a run.
+//
+{
+    FREE(project->StateRegions);
+    project->NumStateRegions = 0;
+    project->MaxStateRegions = 0;
+    project->StateSize = 0;
+}
+
+//=============================================================================
+
+Project* snapshot_fork(Project *project)
+//
+//  Input:   none
+//  Output:  returns a new project continuing the current run, or NULL
+//  Purpose: forks a running simulation, sharing its input data.
+//
+{
+    int     i, n;
+    size_t  size = 0;
+    char*   state;
+    Project* fork;
+    TForkRegion* regions;
+    TForkRegion* sorted;
+    char*   owner;
+
+    if ( project->StateRegions == NULL ) findStateRegions(project);
+    if ( project->ErrorCode ) return NULL;
+    n = project->NumStateRegions;
+
+    // --- the fork's state blocks are placed in a single allocation,
+    //     each starting on a 16 byte boundary
+    for (i = 1; i < n; i++)
+    {
+        size += (project->StateRegions[i].size + 15) & ~(size_t)15;
+    }
+    fork = (Project *) malloc(sizeof(Project));
+    regions = (TForkRegion *) malloc(2 * n * sizeof(TForkRegion));
+    if ( fork == NULL || regions == NULL )
+    {
+        FREE(fork);
+        FREE(regions);
+        return NULL;
+    }
+    state = (char *) malloc(MAX(size, 1));
+    if ( state == NULL )
+    {
+        free(fork);
+        free(regions);
+        return NULL;
+    }
+
+    // --- copy each block
+    size = 0;
+    for (i = 0; i < n; i++)
+    {
+        regions[i].data = (char *)project->StateRegions[i].data;
+        regions[i].size = project->StateRegions[i].size;
+        if ( i == 0 ) regions[i].copy = (char *)fork;
+        else
+        {
+            regions[i].copy = state + size;
+            size += (regions[i].size + 15) & ~(size_t)15;
+        }
+        memcpy(regions[i].copy, regions[i].data, regions[i].size);
+    }
+
+    // --- redirect the pointer to each block to the fork's copy of it
+    sorted = regions + n;
+    memcpy(sorted, regions, n * sizeof(TForkRegion));
+    qsort(sorted, n, sizeof(TForkRegion), compareForkRegions);
+    for (i = 1; i < n; i++)
+    {
+        owner = findForkCopy(sorted, n, (char *)project->StateRegions[i].owner);
+        if ( owner ) *(char **)owner = regions[i].copy;
+    }
+    free(regions);
+
+    // --- rows of the routing interface matrices follow the first one
+    n = 1 + fork->NumIfacePolluts;
+    for (i = 1; fork->OldIfaceValues && i < fork->NumIfaceNodes; i++)
+    {
+        fork->OldIfaceValues[i] = fork->OldIfaceValues[i-1] + n;
+        fork->NewIfaceValues[i] = fork->NewIfaceValues[i-1] + n;
+    }
+
+    // --- items the fork must not share with its parent
+    fork->ForkParent = project;
+    fork->ForkState = state;
+    fork->ForkStateSize = MAX(size, 1);
+    fork->StateRegions = NULL;
+    fork->NumStateRegions = 0;
+    fork->MaxStateRegions = 0;
+    fork->StateSize = 0;
+    fork->ActionList = NULL;
+    fork->SaveResultsFlag = FALSE;
+    fork->RptFlags.controls = FALSE;
+    fork->checkpointWriter = NULL;
+    fork->CheckpointStep = 0.0;
+    memset(&fork->Trace, 0, sizeof(fork->Trace));
+    memset(&fork->Progress, 0, sizeof(fork->Progress));
+    fork->ThreadTuner.count = 0;
+    fork->ThreadCounters = NULL;
+    fork->NumThreadCounters = 0;
+    fork->ReservedThreads = 0;
+    fork->SubcatchResults = NULL;
+    fork->NodeResults = NULL;
+    fork->LinkResults = NULL;
+    fork->couplingDataCache = NULL;
+    lid_detachRptFiles(fork);
+
+    i = allocForkWorkspace(fork, project);
+    if ( !openForkFiles(fork, project) || !i )
+    {
+        snapshot_closeFork(fork);
+        free(fork);
+        return NULL;
+    }
+    initializeCouplingDataCache(fork);
+    return fork;
+}
+
+//=============================================================================
+
+void snapshot_closeFork(Project *fork)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: frees the memory & closes the files owned by a forked run.
+//
+{
+    int     i;
+    TFile*  files = &fork->Finp;
+    TActionList* listItem;
+
+    disposeCoupledDataCache(fork);
+
+    // --- files Finp through Fhotspots
+    for (i = 0; i < NUM_PROJECT_FILES; i++)
+    {
+        if ( files[i].file ) fclose(files[i].file);
+        files[i].file = NULL;
+    }
+    for (i = 0; i < fork->Nobjects[CURVE]; i++)
+    {
+        if ( fork->Curve[i].file.file ) fclose(fork->Curve[i].file.file);
+        fork->Curve[i].file.file = NULL;
+    }
+    for (i = 0; i < fork->Nobjects[TSERIES]; i++)
+    {
+        if ( fork->Tseries[i].file.file ) fclose(fork->Tseries[i].file.file);
+        fork->Tseries[i].file.file = NULL;
+    }
+
+    while ( fork->ActionList )
+    {
+        listItem = fork->ActionList->next;
+        free(fork->ActionList);
+        fork->ActionList = listItem;
+    }
+    odesolve_close(fork);
+    FREE(fork->OutflowLoad);
+    FREE(fork->R);
+    FREE(fork->Cin);
+    FREE(fork->LinkCost);
+    FREE(fork->NodeCost);
+    FREE(fork->LinkWorkStart);
+    FREE(fork->NodeWorkStart);
+    snapshot_close(fork);
+    FREE(fork->ForkState);
+}
+
+//=============================================================================
+
+void findStateRegions(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: lists the blocks of memory that hold the simulation's state.
+//
+{
+    project->NumStateRegions = 0;
+    project->MaxStateRegions = 0;
+    project->StateSize = 0;
+
+    addRegion(project, project, NULL, sizeof(Project));
+    addObjectRegions(project);
+    addQualityRegions(project);
+    addResultRegions(project);
+    lid_addStateRegions(project);
+}
+
+//=============================================================================
+
+void addObjectRegions(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: adds the object arrays and their hydrologic & hydraulic state.
+//
+{
+    int     i, j;
+    int     n = project->Nobjects[SUBCATCH];
+    TRule*  rule;
+    TAction** action;
+    TExfil* exfil;
+
+    snapshot_addRegion(project, &project->Gage, project->Nobjects[GAGE] * sizeof(TGage));
+    snapshot_addRegion(project, &project->Subcatch, n * sizeof(TSubcatch));
+    snapshot_addRegion(project, &project->Snowmelt, project->Nobjects[SNOWMELT] * sizeof(TSnowmelt));
+    snapshot_addRegion(project, &project->Node, project->Nobjects[NODE] * sizeof(TNode));
+    snapshot_addRegion(project, &project->Outfall, project->Nnodes[OUTFALL] * sizeof(TOutfall));
+    snapshot_addRegion(project, &project->Storage, project->Nnodes[STORAGE] * sizeof(TStorage));
+    snapshot_addRegion(project, &project->Link, project->Nobjects[LINK] * sizeof(TLink));
+    snapshot_addRegion(project, &project->Conduit, project->Nlinks[CONDUIT] * sizeof(TConduit));
+    snapshot_addRegion(project, &project->Pump, project->Nlinks[PUMP] * sizeof(TPump));
+    snapshot_addRegion(project, &project->Orifice, project->Nlinks[ORIFICE] * sizeof(TOrifice));
+    snapshot_addRegion(project, &project->Weir, project->Nlinks[WEIR] * sizeof(TWeir));
+    snapshot_addRegion(project, &project->Outlet, project->Nlinks[OUTLET] * sizeof(TOutlet));
+
+    // --- tables hold the position of their last lookup
+    snapshot_addRegion(project, &project->Curve, project->Nobjects[CURVE] * sizeof(TTable));
+    snapshot_addRegion(project, &project->Tseries, project->Nobjects[TSERIES] * sizeof(TTable));
+
+    // --- groundwater, snow pack & infiltration state of subcatchments
+    for (j = 0; j < n; j++)
+    {
+        snapshot_addRegion(project, &project->Subcatch[j].groundwater, sizeof(TGroundwater));
+        snapshot_addRegion(project, &project->Subcatch[j].snowpack, sizeof(TSnowpack));
+    }
+    snapshot_addRegion(project, &project->HortInfil, n * sizeof(THorton));
+    snapshot_addRegion(project, &project->GAInfil, n * sizeof(TGrnAmpt));
+    snapshot_addRegion(project, &project->CNInfil, n * sizeof(TCurveNum));
+
+    // --- storage unit exfiltration
+    for (j = 0; j < project->Nnodes[STORAGE]; j++)
+    {
+        exfil = project->Storage[j].exfil;
+        if ( exfil == NULL ) continue;
+        snapshot_addRegion(project, &project->Storage[j].exfil, sizeof(TExfil));
+        snapshot_addRegion(project, &exfil->btmExfil, sizeof(TGrnAmpt));
+        snapshot_addRegion(project, &exfil->bankExfil, sizeof(TGrnAmpt));
+    }
+
+    // --- dynamic wave node state & active element lists
+    if ( project->Xnode )
+    {
+        snapshot_addRegion(project, &project->Xnode, project->Nobjects[NODE] * sizeof(TXnode));
+        snapshot_addRegion(project, &project->ActiveNodes, project->Nobjects[NODE] * sizeof(int));
+        snapshot_addRegion(project, &project->ActiveLinks, project->Nobjects[LINK] * sizeof(int));
+    }
+
+    // --- control actions hold PID controller errors
+    snapshot_addRegion(project, &project->Rules, project->RuleCount * sizeof(TRule));
+    for (i = 0; i < project->RuleCount; i++)
+    {
+        rule = &project->Rules[i];
+        for (action = &rule->thenActions; *action; action = &(*action)->next)
+            snapshot_addRegion(project, action, sizeof(TAction));
+        for (action = &rule->elseActions; *action; action = &(*action)->next)
+            snapshot_addRegion(project, action, sizeof(TAction));
+    }
+
+    // --- routing interface file & RDII inflows
+    if ( project->OldIfaceValues )
+    {
+        i = project->NumIfaceNodes * (1 + project->NumIfacePolluts);
+        snapshot_addRegion(project, &project->OldIfaceValues,
+                           project->NumIfaceNodes * sizeof(double *));
+        snapshot_addRegion(project, &project->NewIfaceValues,
+                           project->NumIfaceNodes * sizeof(double *));
+        snapshot_addRegion(project, &project->OldIfaceValues[0], i * sizeof(double));
+        snapshot_addRegion(project, &project->NewIfaceValues[0], i * sizeof(double));
+    }
+    snapshot_addRegion(project, &project->RdiiNodeFlow, project->NumRdiiNodes * sizeof(float));
+}
+
+//=============================================================================
+
+void addQualityRegions(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: adds the pollutant state of subcatchments, nodes & links.
+//
+{
+    int     j, k;
+    size_t  size = project->Nobjects[POLLUT] * sizeof(double);
+    TSubcatch* subcatch;
+
+    if ( size == 0 ) return;
+    for (j = 0; j < project->Nobjects[SUBCATCH]; j++)
+    {
+        subcatch = &project->Subcatch[j];
+        snapshot_addRegion(project, &subcatch->oldQual, size);
+        snapshot_addRegion(project, &subcatch->newQual, size);
+        snapshot_addRegion(project, &subcatch->pondedQual, size);
+        snapshot_addRegion(project, &subcatch->totalLoad, size);
+        snapshot_addRegion(project, &subcatch->landFactor,
+                           project->Nobjects[LANDUSE] * sizeof(TLandFactor));
+        for (k = 0; k < project->Nobjects[LANDUSE]; k++)
+        {
+            snapshot_addRegion(project, &subcatch->landFactor[k].buildup, size);
+        }
+    }
+    for (j = 0; j < project->Nobjects[NODE]; j++)
+    {
+        snapshot_addRegion(project, &project->Node[j].oldQual, size);
+        snapshot_addRegion(project, &project->Node[j].newQual, size);
+    }
+    for (j = 0; j < project->Nnodes[OUTFALL]; j++)
+    {
+        snapshot_addRegion(project, &project->Outfall[j].wRouted, size);
+    }
+    for (j = 0; j < project->Nobjects[LINK]; j++)
+    {
+        snapshot_addRegion(project, &project->Link[j].oldQual, size);
+        snapshot_addRegion(project, &project->Link[j].newQual, size);
+        snapshot_addRegion(project, &project->Link[j].totalLoad, size);
+    }
+}
+
+//=============================================================================
+
+void addResultRegions(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: adds the mass balance & summary statistics accumulators.
+//
+{
+    int    j;
+    int    nPollut = project->Nobjects[POLLUT];
+
+    snapshot_addRegion(project, &project->LoadingTotals, nPollut * sizeof(TLoadingTotals));
+    snapshot_addRegion(project, &project->QualTotals, nPollut * sizeof(TRoutingTotals));
+    snapshot_addRegion(project, &project->StepQualTotals, nPollut * sizeof(TRoutingTotals));
+    snapshot_addRegion(project, &project->NodeInflow, project->Nobjects[NODE] * sizeof(double));
+    snapshot_addRegion(project, &project->NodeOutflow, project->Nobjects[NODE] * sizeof(double));
+
+    snapshot_addRegion(project, &project->SubcatchStats,
+                       project->Nobjects[SUBCATCH] * sizeof(TSubcatchStats));
+    snapshot_addRegion(project, &project->NodeStats, project->Nobjects[NODE] * sizeof(TNodeStats));
+    snapshot_addRegion(project, &project->LinkStats, project->Nobjects[LINK] * sizeof(TLinkStats));
+    snapshot_addRegion(project, &project->StorageStats,
+                       project->Nnodes[STORAGE] * sizeof(TStorageStats));
+    snapshot_addRegion(project, &project->PumpStats, project->Nlinks[PUMP] * sizeof(TPumpStats));
+    if ( project->NodeSolverStats )
+    {
+        snapshot_addRegion(project, &project->NodeSolverStats,
+                           project->Nobjects[NODE] * sizeof(TSolverStats));
+        snapshot_addRegion(project, &project->LinkSolverStats,
+                           project->Nobjects[LINK] * sizeof(TSolverStats));
+    }
+    if ( project->OutfallStats )
+    {
+        snapshot_addRegion(project, &project->OutfallStats,
+                           project->Nnodes[OUTFALL] * sizeof(TOutfallStats));
+        for (j = 0; j < project->Nnodes[OUTFALL]; j++)
+        {
+            snapshot_addRegion(project, &project->OutfallStats[j].totalLoad,
+                               nPollut * sizeof(double));
+        }
+    }
+}
+
+//=============================================================================
+
+TFile* getStateFile(Project *project, int i)
+//
+//  Input:   i = type of sequentially read input file
+//  Output:  returns the file if it is open for reading, NULL otherwise
+//  Purpose: finds the input files whose read position is part of the state.
+//
+{
+    TFile* f = NULL;
+
+    switch ( i )
+    {
+      case STATE_CLIMATE_FILE: f = &project->Fclimate; break;
+      case STATE_RDII_FILE:    f = &project->Frdii;    break;
+      case STATE_INFLOWS_FILE: f = &project->Finflows; break;
+      case STATE_RUNOFF_FILE:
+        if ( project->Frunoff.mode == USE_FILE ) f = &project->Frunoff;
+        break;
+    }
+    if ( f && f->file ) return f;
+    return NULL;
+}
+
+//=============================================================================
+
+void addRegion(Project *project, void* data, void* owner, size_t size)
+//
+//  Input:   data = start of a block of state data
+//           owner = location of the pointer to the block (NULL for the
+//                   project itself)
+//           size = size of the block (bytes)
+//  Output:  none
+//  Purpose: adds a block of memory to the list of state regions.
+//
+{
+    TStateRegion* regions;
+
+    if ( data == NULL || size == 0 ) return;
+    if ( project->NumStateRegions == project->MaxStateRegions )
+    {
+        project->MaxStateRegions = MAX(2 * project->MaxStateRegions, 64);
+        regions = (TStateRegion *) realloc(project->StateRegions,
+                  project->MaxStateRegions * sizeof(TStateRegion));
+        if ( regions == NULL )
+        {
+            report_writeErrorMsg(project, ERR_MEMORY, "");
+            return;
+        }
+        project->StateRegions = regions;
+    }
+    project->StateRegions[project->NumStateRegions].data = data;
+    project->StateRegions[project->NumStateRegions].owner = owner;
+    project->StateRegions[project->NumStateRegions].size = size;
+    project->NumStateRegions++;
+    project->StateSize += size;
+}
+
+//=============================================================================
+
+int compareForkRegions(const void* a, const void* b)
+//
+//  Input:   a, b = pointers to two TForkRegion items
+//  Output:  returns -1, 0 or 1
+//  Purpose: orders state regions by address for qsort.
+//
+{
+    const char* d1 = ((const TForkRegion *)a)->data;
+    const char* d2 = ((const TForkRegion *)b)->data;
+    if ( d1 < d2 ) return -1;
+    if ( d1 > d2 ) return 1;
+    return 0;
+}
+
+//=============================================================================
+
+char* findForkCopy(TForkRegion* sorted, int n, char* p)
+//
+//  Input:   sorted = state regions sorted by address
+//           n = number of regions
+//           p = address inside a parent's state block
+//  Output:  returns the matching address in the fork's copy, or NULL
+//  Purpose: maps a location in a parent's state onto its fork.
+//
+{
+    int lo = 0, hi = n - 1, mid;
+
+    // --- find the last region starting at or before p
+    while ( lo < hi )
+    {
+        mid = (lo + hi + 1) / 2;
+        if ( sorted[mid].data <= p ) lo = mid;
+        else hi = mid - 1;
+    }
+    if ( p < sorted[lo].data || p >= sorted[lo].data + sorted[lo].size ) return NULL;
+    return sorted[lo].copy + (p - sorted[lo].data);
+}
+
+//=============================================================================
+
+int openForkFiles(Project *fork, Project *parent)
+//
+//  Input:   fork = forked project
+//           parent = project the fork was made from
+//  Output:  returns TRUE if successful
+//  Purpose: gives a fork its own handles on the files it reads from.
+//
+{
+    int     i;
+    int     ok = TRUE;
+    TFile*  files = &fork->Finp;
+
+    // --- files Finp through Fhotspots; only those read during a run
+    //     are reopened and the fork writes none of them
+    for (i = 0; i < NUM_PROJECT_FILES; i++) files[i].file = NULL;
+    for (i = 0; i < fork->Nobjects[CURVE]; i++) fork->Curve[i].file.file = NULL;
+    for (i = 0; i < fork->Nobjects[TSERIES]; i++) fork->Tseries[i].file.file = NULL;
+    fork->Fout.mode = NO_FILE;
+    fork->Fhotstart2.mode = NO_FILE;
+    fork->Foutflows.mode = NO_FILE;
+    fork->Ftrace.mode = NO_FILE;
+    fork->Fhotspots.mode = NO_FILE;
+    if ( fork->Frunoff.mode != USE_FILE ) fork->Frunoff.mode = NO_FILE;
+
+    ok = ok && openForkFile(&fork->Frain, &parent->Frain, "rb");
+    ok = ok && openForkFile(&fork->Fclimate, &parent->Fclimate, "rt");
+    ok = ok && openForkFile(&fork->Frdii, &parent->Frdii,
+                            fork->RdiiFileType == TEXT ? "rt" : "rb");
+    ok = ok && openForkFile(&fork->Finflows, &parent->Finflows, "rt");
+    ok = ok && openForkFile(&fork->Frunoff, &parent->Frunoff, "rb");
+
+    // --- time series & curves read from external files
+    for (i = 0; ok && i < fork->Nobjects[CURVE]; i++)
+        ok = openForkFile(&fork->Curve[i].file, &parent->Curve[i].file, "rt");
+    for (i = 0; ok && i < fork->Nobjects[TSERIES]; i++)
+        ok = openForkFile(&fork->Tseries[i].file, &parent->Tseries[i].file, "rt");
+    return ok;
+}
+
+//=============================================================================
+
+int openForkFile(TFile* f, TFile* parentFile, char* mode)
+//
+//  Input:   f = fork's copy of a file
+//           parentFile = parent's file
+//           mode = mode the file is read in
+//  Output:  returns TRUE if successful
+//  Purpose: opens a file the parent has open at the parent's read position.
+//
+{
+    if ( parentFile->file == NULL ) return TRUE;
+    f->file = fopen(parentFile->name, mode);
+    if ( f->file == NULL ) return FALSE;
+    fseek(f->file, ftell(parentFile->file), SEEK_SET);
+    return TRUE;
+}
+
+//=============================================================================
+
+int allocForkWorkspace(Project *fork, Project *parent)
+//
+//  Input:   fork = forked project
+//           parent = project the fork was made from
+//  Output:  returns TRUE if successful
+//  Purpose: allocates the fork's own scratch arrays used during a time step.
+//
+{
+    int     nPollut = fork->Nobjects[POLLUT];
+    int     nThreads = MAX(fork->NumThreads, 1) + 1;
+    int     ok = TRUE;
+
+    fork->y = NULL;
+    fork->yscal = NULL;
+    fork->dydx = NULL;
+    fork->yerr = NULL;
+    fork->ytemp = NULL;
+    fork->ak = NULL;
+    fork->OutflowLoad = NULL;
+    fork->R = NULL;
+    fork->Cin = NULL;
+    fork->LinkCost = NULL;
+    fork->NodeCost = NULL;
+    fork->LinkWorkStart = NULL;
+    fork->NodeWorkStart = NULL;
+
+    if ( parent->nmax > 0 ) ok = odesolve_open(fork, parent->nmax);
+    if ( parent->OutflowLoad )
+    {
+        fork->OutflowLoad = (double *) calloc(nPollut, sizeof(double));
+        ok = ok && fork->OutflowLoad;
+    }
+    if ( parent->R )
+    {
+        fork->R = (double *) calloc(nPollut, sizeof(double));
+        fork->Cin = (double *) calloc(nPollut, sizeof(double));
+        ok = ok && fork->R && fork->Cin;
+    }
+
+    // --- a fork starts from its parent's measured routing costs
+    if ( parent->LinkCost )
+    {
+        fork->LinkCost = (double *) malloc((fork->Nobjects[LINK] + 1) * sizeof(double));
+        fork->NodeCost = (double *) malloc((fork->Nobjects[NODE] + 1) * sizeof(double));
+        fork->LinkWorkStart = (int *) calloc(nThreads, sizeof(int));
+        fork->NodeWorkStart = (int *) calloc(nThreads, sizeof(int));
+        if ( !fork->LinkCost || !fork->NodeCost || !fork->LinkWorkStart
+        ||   !fork->NodeWorkStart ) return FALSE;
+        memcpy(fork->LinkCost, parent->LinkCost, (fork->Nobjects[LINK] + 1) * sizeof(double));
+        memcpy(fork->NodeCost, parent->NodeCost, (fork->Nobjects[NODE] + 1) * sizeof(double));
+        fork->WorkPartsChanged = TRUE;
+    }
+    return ok;
+}
+
+//=============================================================================
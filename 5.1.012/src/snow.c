@@ -398,7 +398,7 @@ void snow_plowSnow(Project *project, int j, double tStep)
     if ( !snowpack ) return;
 
     // --- see if there's any snowfall
-    gage_getPrecip(project, project->Subcatch[j].gage, &rainfall, &snowfall);
+    subcatch_getPrecip(project, j, &rainfall, &snowfall);
 
     // --- add snowfall to snow pack
     for (i=SNOW_PLOWABLE; i<=SNOW_PERV; i++)
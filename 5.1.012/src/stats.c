@@ -55,6 +55,7 @@
 #define _CRT_SECURE_NO_DEPRECATE
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <omp.h>                                                               //(5.1.008)
 #include "headers.h"
@@ -79,6 +80,7 @@
 //  stats_updateFlowStats         (called from routing_execute)
 //  stats_updateCriticalTimeCount (called from getVariableStep in dynwave.c)
 //  stats_updateMaxNodeDepth      (called from output_saveNodeResults)         //(5.1.008)
+//  stats_writeSolverStats        (called from stats_report)
 
 //-----------------------------------------------------------------------------
 //  Local functions
@@ -87,6 +89,8 @@ static void stats_updateNodeStats(Project *project, int node, double tStep, Date
 static void stats_updateLinkStats(Project *project, int link, double tStep, DateTime aDate);
 static void stats_findMaxStats(Project *project);
 static void stats_updateMaxStats(TMaxStats maxStats[], int i, int j, double x);
+static void stats_writeSolverRow(FILE* f, char* type, char* id,
+            TSolverStats* stats, double criticalSteps);
 
 //=============================================================================
 
@@ -105,6 +109,8 @@ int  stats_open(Project *project)
     project->StorageStats = NULL;
     project->OutfallStats = NULL;
     project->PumpStats = NULL;
+    project->NodeSolverStats = NULL;
+    project->LinkSolverStats = NULL;
 
     // --- allocate memory for & initialize subcatchment statistics
     project->SubcatchStats = NULL;
@@ -153,6 +159,20 @@ int  stats_open(Project *project)
             report_writeErrorMsg(project, ERR_MEMORY, "");
             return project->ErrorCode;
         }
+
+        // --- solver statistics are only kept when saved to a file
+        if ( project->Fhotspots.mode == SAVE_FILE )
+        {
+            project->NodeSolverStats = (TSolverStats *)
+                calloc(project->Nobjects[NODE], sizeof(TSolverStats));
+            project->LinkSolverStats = (TSolverStats *)
+                calloc(project->Nobjects[LINK], sizeof(TSolverStats));
+            if ( !project->NodeSolverStats || !project->LinkSolverStats )
+            {
+                report_writeErrorMsg(project, ERR_MEMORY, "");
+                return project->ErrorCode;
+            }
+        }
     }
 
     // --- initialize node stats
@@ -304,6 +324,8 @@ void  stats_close(Project *project)
         FREE(project->OutfallStats);
     }
     FREE(project->PumpStats);
+    FREE(project->NodeSolverStats);
+    FREE(project->LinkSolverStats);
 }
 
 //=============================================================================
@@ -324,6 +346,9 @@ void  stats_report(Project *project)
         report_writeSysStats(project, &project->SysStats);
     }
 
+    // --- save per element solver statistics
+    if ( project->NodeSolverStats ) stats_writeSolverStats(project);
+
     // --- report summary statistics
     statsrpt_writeReport(project);
 }
@@ -465,16 +490,100 @@ void   stats_updateFlowStats(Project *project, double tStep, DateTime aDate, int
 
 //=============================================================================
    
-void stats_updateCriticalTimeCount(Project *project, int node, int link)
+void stats_updateCriticalTimeCount(Project *project, int node, int link,
+                                   double tStep)
 //
 //  Input:   node = node index
 //           link = link index
+//           tStep = time step set by the node or link (sec)
 //  Output:  none
 //  Purpose: updates count of times a node or link was time step-critical.
 //
 {
-    if      ( node >= 0 ) project->NodeStats[node].timeCourantCritical += 1.0;
-    else if ( link >= 0 ) project->LinkStats[link].timeCourantCritical += 1.0;
+    if ( node >= 0 )
+    {
+        project->NodeStats[node].timeCourantCritical += 1.0;
+        if ( project->NodeSolverStats )
+            project->NodeSolverStats[node].criticalTime += tStep;
+    }
+    else if ( link >= 0 )
+    {
+        project->LinkStats[link].timeCourantCritical += 1.0;
+        if ( project->LinkSolverStats )
+            project->LinkSolverStats[link].criticalTime += tStep;
+    }
+}
+
+//=============================================================================
+
+void stats_writeSolverStats(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes the solver statistics of each node and link to the
+//           hotspots file as comma separated values.
+//
+{
+    int   j;
+    FILE* f;
+
+    f = fopen(project->Fhotspots.name, "wt");
+    if ( f == NULL )
+    {
+        report_writeErrorMsg(project, ERR_HOTSPOTS_FILE_OPEN,
+                             project->Fhotspots.name);
+        return;
+    }
+    fprintf(f, "Type,Name,Trials,Unconverged Trials,Unconverged Steps,"
+               "Surcharged Trials,Root Evaluations,Critical Time (sec),"
+               "Critical Steps\n");
+    for ( j = 0; j < project->Nobjects[NODE]; j++ )
+    {
+        stats_writeSolverRow(f, "Node", project->Node[j].ID,
+                             &project->NodeSolverStats[j],
+                             project->NodeStats[j].timeCourantCritical);
+    }
+    for ( j = 0; j < project->Nobjects[LINK]; j++ )
+    {
+        stats_writeSolverRow(f, "Link", project->Link[j].ID,
+                             &project->LinkSolverStats[j],
+                             project->LinkStats[j].timeCourantCritical);
+    }
+    if ( ferror(f) | fclose(f) )
+        report_writeErrorMsg(project, ERR_HOTSPOTS_FILE_OPEN,
+                             project->Fhotspots.name);
+}
+
+//=============================================================================
+
+void stats_writeSolverRow(FILE* f, char* type, char* id, TSolverStats* stats,
+                          double criticalSteps)
+//
+//  Input:   f = hotspots file
+//           type = "Node" or "Link"
+//           id = element's ID name
+//           stats = element's solver statistics
+//           criticalSteps = number of steps element was time step-critical
+//  Output:  none
+//  Purpose: writes a line of the hotspots file.
+//
+{
+    fprintf(f, "%s,", type);
+    if ( strpbrk(id, ",\"") )
+    {
+        fputc('"', f);
+        for ( ; *id; id++ )
+        {
+            if ( *id == '"' ) fputc('"', f);
+            fputc(*id, f);
+        }
+        fputc('"', f);
+    }
+    else fputs(id, f);
+    fprintf(f, ",%ld,%ld,%ld,%ld,%ld,%.3f,%.0f\n", stats->trials,
+            stats->unconvergedTrials, stats->unconvergedSteps,
+            stats->surchargedTrials, stats->rootEvaluations,
+            stats->criticalTime, criticalSteps);
 }
 
 //=============================================================================
@@ -66,6 +66,7 @@
 #include "headers.h"
 #include "lid.h"
 #include "odesolve.h"
+#include "dataexchangecache.h"
 
 //-----------------------------------------------------------------------------
 // Constants 
@@ -95,6 +96,7 @@ static  char *RunoffRoutingWords[] = { w_OUTLET,  w_IMPERV, w_PERV, NULL};
 //  subcatch_addRunon          (called from subcatch_getRunon,
 //                              lid_addDrainRunon, & runoff_getOutfallRunon)   //(5.1.008)
 //  subcatch_getRunoff         (called from runoff_execute)
+//  subcatch_getPrecip         (called from getNetPrecip & snow_plowSnow)
 //  subcatch_hadRunoff         (called from runoff_execute)
 
 //  subcatch_getFracPerv       (called from gwater_initState)
@@ -756,6 +758,35 @@ double subcatch_getRunoff(Project *project, int j, double tStep)
 
 //=============================================================================
 
+void subcatch_getPrecip(Project *project, int j, double *rainfall, double *snowfall)
+//
+//  Input:   j = subcatchment index
+//  Output:  rainfall = rainfall rate (ft/sec)
+//           snowfall = snow fall rate (ft/sec)
+//  Purpose: finds the precipitation falling on a subcatchment, using a
+//           rainfall intensity supplied through the coupling data cache
+//           (e.g. from a rainfall grid) in place of its rain gage's.
+//
+{
+    int    k = project->Subcatch[j].gage;
+    double intensity;                  // coupled rainfall (in/hr or mm/hr)
+
+    *rainfall = 0.0;
+    *snowfall = 0.0;
+    if ( containsSubcatchRain(project, j, &intensity) )
+    {
+        if ( !project->IgnoreSnowmelt && project->Temp.ta <= project->Snow.snotmp )
+        {
+            if ( k >= 0 ) intensity *= project->Gage[k].snowFactor;
+            *snowfall = intensity / UCF(project, RAINFALL);
+        }
+        else *rainfall = intensity / UCF(project, RAINFALL);
+    }
+    else if ( k >= 0 ) gage_getPrecip(project, k, rainfall, snowfall);
+}
+
+//=============================================================================
+
 void getNetPrecip(Project *project, int j, double* netPrecip, double tStep)
 {
 //
@@ -764,16 +795,12 @@ void getNetPrecip(Project *project, int j, double* netPrecip, double tStep)
 //           tStep = time step (sec)
 //  Output:  netPrecip = rainfall + snowmelt over each type of subarea (ft/s)
 //
-    int    i, k;
+    int    i;
     double rainfall = 0.0;             // rainfall (ft/sec)
     double snowfall = 0.0;             // snowfall (ft/sec)
 
-    // --- get current rainfall or snowfall from rain gage (in ft/sec)
-    k = project->Subcatch[j].gage;
-    if ( k >= 0 )
-    {
-        gage_getPrecip(project, k, &rainfall, &snowfall);
-    }
+    // --- get current rainfall or snowfall (in ft/sec)
+    subcatch_getPrecip(project, j, &rainfall, &snowfall);
 
     // --- assign total precip. rate to subcatch's rainfall property
     project->Subcatch[j].rainfall = rainfall + snowfall;
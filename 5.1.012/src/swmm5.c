@@ -202,12 +202,10 @@ int  main(int argc, char *argv[])
   time_t start;
   double runTime;
 
-  Project *project = (Project*)malloc(sizeof(Project));
+  Project *project;
 
-  // --- initialize flags
-  project->IsOpenFlag = FALSE;
-  project->IsStartedFlag = FALSE;
-  project->SaveResultsFlag = TRUE;
+  // --- create a project with all of its flags & pointers initialized
+  swmm_createProject(&project);
 
   // --- check for proper number of command line arguments
   start = time(0);
@@ -238,7 +236,7 @@ int  main(int argc, char *argv[])
     writecon("    Press Enter to continue...");
     getchar();
 */
-  FREE(project);
+  swmm_deleteProject(project);
   return 0;
 }                                      /* End of main */
 #endif
@@ -251,12 +249,28 @@ void DLLEXPORT swmm_createProject(Project **project)
   (*project)->IsStartedFlag = FALSE;
   (*project)->SaveResultsFlag = TRUE;
   (*project)->ErrorCode = 0;
+  (*project)->StateRegions = NULL;
+  (*project)->NumStateRegions = 0;
+  (*project)->MaxStateRegions = 0;
+  (*project)->StateSize = 0;
+  (*project)->ForkParent = NULL;
+  (*project)->ForkState = NULL;
+  (*project)->ForkStateSize = 0;
+  (*project)->checkpointWriter = NULL;
+  memset((*project)->PerfTimers, 0, sizeof((*project)->PerfTimers));
+  memset(&(*project)->Trace, 0, sizeof((*project)->Trace));
+  memset(&(*project)->Progress, 0, sizeof((*project)->Progress));
+  (*project)->NodeSolverStats = NULL;
+  (*project)->LinkSolverStats = NULL;
+  (*project)->ThreadCounters = NULL;
+  (*project)->NumThreadCounters = 0;
   (*project)->couplingDataCache = NULL;
 //  (*project)->Htable = malloc(MAX_OBJ_TYPES * sizeof(HTtable*));
 }
 
 void  DLLEXPORT swmm_deleteProject(Project *project)
 {
+  if ( project->ForkParent && project->IsOpenFlag ) snapshot_closeFork(project);
   disposeCoupledDataCache(project);
   FREE(project);
 }
@@ -459,6 +473,9 @@ int DLLEXPORT swmm_start(Project *project, int saveResults)
     // --- open mass balance and statistics processors
     massbal_open(project);
     stats_open(project);
+    perf_open(project);
+    trace_open(project);
+    progress_open(project);
 
     // --- write project options to report file
     report_writeOptions(project);
@@ -501,6 +518,8 @@ int DLLEXPORT swmm_step(Project *project, double* elapsedTime)
   __try
     #endif
   {
+    perf_start(project, PERF_STEP);
+
     // --- if routing time has not exceeded total duration
     if ( project->NewRoutingTime < project->TotalDuration )
     {
@@ -514,11 +533,19 @@ int DLLEXPORT swmm_step(Project *project, double* elapsedTime)
     if ( project->NewRoutingTime >= project->ReportTime )
     {
       if ( project->SaveResultsFlag )
+      {
+        perf_start(project, PERF_OUTPUT);
         output_saveResults(project, project->ReportTime);
+        perf_stop(project, PERF_OUTPUT, 0);
+      }
 
       project->ReportTime = project->ReportTime + (double)(1000 * project->ReportStep);
     }
 
+    // --- save a hot start checkpoint when one is due
+    hotstart_checkpoint(project);
+    perf_stop(project, PERF_STEP, 0);
+
     // --- update elapsed time (days)
     if ( project->NewRoutingTime < project->TotalDuration )
     {
@@ -529,6 +556,9 @@ int DLLEXPORT swmm_step(Project *project, double* elapsedTime)
       project->ElapsedTime = 0.0;                                                //(5.1.011)
 
     *elapsedTime = project->ElapsedTime;                                            //(5.1.011)
+
+    // --- report progress to a registered callback
+    if ( !project->ErrorCode ) progress_update(project);
   }
 
 #ifdef EXH                                                                     //(5.1.011)
@@ -583,7 +613,9 @@ void execRouting(Project *project)
     // --- compute runoff until next routing time reached or exceeded
     if ( project->DoRunoff ) while ( project->NewRunoffTime < nextRoutingTime )
     {
+      perf_start(project, PERF_RUNOFF);
       runoff_execute(project);
+      perf_stop(project, PERF_RUNOFF, 0);
       if ( project->ErrorCode ) return;
     }
 
@@ -592,7 +624,12 @@ void execRouting(Project *project)
 
     // --- route flows & pollutants through drainage system                //(5.1.008)
     //     (while updating project->NewRoutingTime)                                 //(5.1.008)
-    if ( project->DoRouting ) routing_execute(project, project->RouteModel, routingStep);
+    if ( project->DoRouting )
+    {
+      perf_start(project, PERF_ROUTING);
+      routing_execute(project, project->RouteModel, routingStep);
+      perf_stop(project, PERF_ROUTING, 0);
+    }
     else project->NewRoutingTime = nextRoutingTime;
   }
 
@@ -623,6 +660,13 @@ int DLLEXPORT swmm_end(Project *project)
     return error_getCode(project->ErrorCode);                                       //(5.1.011)
   }
 
+  // --- a forked run's data is freed when it is closed
+  if ( project->ForkParent )
+  {
+    project->IsStartedFlag = FALSE;
+    return error_getCode(project->ErrorCode);
+  }
+
   if ( project->IsStartedFlag )
   {
     // --- write ending records to binary output file
@@ -634,6 +678,8 @@ int DLLEXPORT swmm_end(Project *project)
     {
       massbal_report(project);
       stats_report(project);
+      if ( project->PerfStats ) report_writePerfStats(project);
+      if ( project->PerfCounters ) report_writePerfCounters(project);
     }
 
     // --- close all computing systems
@@ -643,6 +689,9 @@ int DLLEXPORT swmm_end(Project *project)
     if ( project->DoRunoff ) runoff_close(project);
     if ( project->DoRouting ) routing_close(project, project->RouteModel);
     hotstart_close(project);
+    snapshot_close(project);
+    trace_close(project);
+    perf_close(project);
     project->IsStartedFlag = FALSE;
   }
   return error_getCode(project->ErrorCode);                                           //(5.1.011)
@@ -657,6 +706,9 @@ int DLLEXPORT swmm_report(Project *project)
 //  Purpose: writes simulation results to report file.
 //
 {
+  // --- a forked run has no report file
+  if ( project->ForkParent ) return error_getCode(project->ErrorCode);
+
   if ( project->Fout.mode == SCRATCH_FILE ) output_checkFileSize(project);
   if ( project->ErrorCode ) report_writeErrorCode(project);
   else
@@ -676,6 +728,15 @@ int DLLEXPORT swmm_close(Project *project)
 //  Purpose: closes a SWMM project.
 //
 {
+  // --- a forked run only frees what it does not share with its parent
+  if ( project->ForkParent )
+  {
+    if ( project->IsOpenFlag ) snapshot_closeFork(project);
+    project->IsOpenFlag = FALSE;
+    project->IsStartedFlag = FALSE;
+    return 0;
+  }
+
   disposeCoupledDataCache(project);
 
   if ( project->Fout.file ) output_close(project);
@@ -750,6 +811,180 @@ int DLLEXPORT swmm_getWarnings(Project *project)
 
 //=============================================================================
 
+int DLLEXPORT swmm_getStateSize(Project *project, size_t* size)
+//
+//  Input:   none
+//  Output:  size = number of bytes needed to save the simulation's state,
+//           returns an error code
+//  Purpose: finds the size of the buffer used by swmm_saveState.
+//
+{
+  *size = 0;
+  if ( project->ErrorCode ) return error_getCode(project->ErrorCode);
+  if ( !project->IsOpenFlag || !project->IsStartedFlag )
+  {
+    report_writeErrorMsg(project, ERR_NOT_OPEN, "");
+    return error_getCode(project->ErrorCode);
+  }
+  *size = snapshot_getSize(project);
+  return error_getCode(project->ErrorCode);
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_saveState(Project *project, void* state, size_t size)
+//
+//  Input:   state = buffer of at least swmm_getStateSize bytes
+//           size = size of state buffer (bytes)
+//  Output:  returns an error code
+//  Purpose: saves the full state of a running simulation in memory.
+//
+{
+  if ( project->ErrorCode ) return error_getCode(project->ErrorCode);
+  if ( !project->IsOpenFlag || !project->IsStartedFlag )
+  {
+    report_writeErrorMsg(project, ERR_NOT_OPEN, "");
+    return error_getCode(project->ErrorCode);
+  }
+  if ( !snapshot_save(project, (char *)state, size) )
+    return error_getCode(ERR_STATE_BUFFER);
+  return error_getCode(project->ErrorCode);
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_restoreState(Project *project, const void* state, size_t size)
+//
+//  Input:   state = buffer filled by swmm_saveState during the current run
+//           size = size of state buffer (bytes)
+//  Output:  returns an error code
+//  Purpose: returns a running simulation to a previously saved state.
+//
+{
+  if ( project->ErrorCode ) return error_getCode(project->ErrorCode);
+  if ( !project->IsOpenFlag || !project->IsStartedFlag )
+  {
+    report_writeErrorMsg(project, ERR_NOT_OPEN, "");
+    return error_getCode(project->ErrorCode);
+  }
+  if ( !snapshot_restore(project, (const char *)state, size) )
+    return error_getCode(ERR_STATE_BUFFER);
+  return error_getCode(project->ErrorCode);
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_fork(Project *project, int count, Project** forks)
+//
+//  Input:   count = number of forks to make
+//  Output:  forks = array receiving count new projects, each continuing
+//           the current run from its present state,
+//           returns an error code
+//  Purpose: branches a running simulation into independent runs that share
+//           its input data, e.g. to run an ensemble of forecasts.
+//
+//  NOTE: forks can be advanced with swmm_step on separate threads and are
+//        freed with swmm_close or swmm_deleteProject. They write no report
+//        or output files and must be closed before their parent is.
+//
+{
+  int i;
+
+  for (i = 0; i < count; i++) forks[i] = NULL;
+  if ( project->ErrorCode ) return error_getCode(project->ErrorCode);
+  if ( !project->IsOpenFlag || !project->IsStartedFlag )
+  {
+    report_writeErrorMsg(project, ERR_NOT_OPEN, "");
+    return error_getCode(project->ErrorCode);
+  }
+  for (i = 0; i < count; i++)
+  {
+    forks[i] = snapshot_fork(project);
+    if ( forks[i] == NULL )
+    {
+      while ( i > 0 )
+      {
+        i--;
+        swmm_deleteProject(forks[i]);
+        forks[i] = NULL;
+      }
+      return error_getCode(ERR_MEMORY);
+    }
+  }
+  return error_getCode(project->ErrorCode);
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_getPerfStats(Project *project, int phase, double* time,
+                                long* calls, long* iterations)
+//
+//  Input:   phase = code of a timed phase of the simulation (0 = a whole
+//           routing step, see PerfPhaseType in enums.h)
+//  Output:  time = total wall clock time spent in the phase (sec)
+//           calls = number of times the phase was run
+//           iterations = total number of iterations made by the phase,
+//           returns an error code
+//  Purpose: retrieves the timing totals collected with the PERF_STATS option
+//           since the run was started.
+//
+{
+  TPerfStats* timer;
+
+  *time = 0.0;
+  *calls = 0;
+  *iterations = 0;
+  if ( phase < 0 || phase >= MAX_PERF_PHASES )
+    return error_getCode(ERR_PERF_PHASE);
+  timer = &project->PerfTimers[phase];
+  *time = timer->time;
+  *calls = timer->calls;
+  *iterations = timer->iterations;
+  return 0;
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_getMemoryUse(Project *project, int type, double* bytes)
+//
+//  Input:   type = a memory use category (see MemoryUseType in enums.h)
+//  Output:  bytes = memory the project currently uses in the category,
+//           returns an error code
+//  Purpose: retrieves how much memory a project holds in each of its
+//           subsystems; can be called at any time after it is created.
+//
+{
+  *bytes = 0.0;
+  if ( type < 0 || type >= MAX_MEMORY_TYPES )
+    return error_getCode(ERR_MEMORY_TYPE);
+  *bytes = memuse_getBytes(project, type);
+  return 0;
+}
+
+//=============================================================================
+
+int DLLEXPORT swmm_setProgressCallback(Project *project, SWMM_ProgressCallback callback,
+                                       double interval, void* userData)
+//
+//  Input:   callback = function passed the progress of a run (NULL to stop
+//                      reporting progress)
+//           interval = wall clock time between calls (sec, 0 = every
+//                      routing step)
+//           userData = pointer passed back to the callback
+//  Output:  returns an error code
+//  Purpose: registers a function that swmm_step calls with the progress of
+//           the run; can be called at any time after a project is created.
+//
+{
+  if ( interval < 0.0 ) return error_getCode(ERR_PROGRESS_INTERVAL);
+  project->Progress.callback = (void (*)(void))callback;
+  project->Progress.userData = userData;
+  project->Progress.interval = interval;
+  return 0;
+}
+
+//=============================================================================
+
 ////  New function added to release 5.1.011.  ////                             //(5.1.011)
 
 int  DLLEXPORT swmm_getError(Project *project, char* errMsg, int msgLen)
@@ -0,0 +1,452 @@
+/*!
+ * \file trace.c
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+//-----------------------------------------------------------------------------
+//   trace.c
+//
+//   Project:  EPA SWMM5
+//   Version:  5.1
+//
+//   Timeline tracing of a simulation.
+//
+//   A [FILES] line "SAVE TRACE filename" records a span for every timed
+//   phase of every routing step (see perf.c) together with the number of
+//   iterations it used, plus an instant event whenever control actions
+//   change link settings. Flow routing spans also carry the routing time
+//   step and are flagged when the step was cut to its minimum or failed to
+//   converge. Events go into a buffer allocated when the run starts, so
+//   recording one is a few stores into memory owned by the project. The
+//   buffer is sized for steps of the routing step and doubles when full,
+//   since variable steps can be much shorter; events beyond its largest
+//   size are counted rather than recorded.
+//
+//   When the run ends the events are written to the file in Chrome's
+//   trace event JSON format, which chrome://tracing and Perfetto display as
+//   a timeline. Each project is a separate track, and projects of the same
+//   process that save to the same file while their runs overlap add their
+//   tracks to it, so runs made concurrently can be viewed side by side. A
+//   run started after all others using the file have ended replaces it.
+//
+//-----------------------------------------------------------------------------
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "headers.h"
+
+//-----------------------------------------------------------------------------
+//  Constants
+//-----------------------------------------------------------------------------
+static const int MIN_TRACE_EVENTS = 1024;
+static const int MAX_TRACE_EVENTS = 2097152;
+
+static char* TraceEventNames[] = {"Step", "Runoff", "Routing", "Controls",
+    "Inflows", "Flow Routing", "Quality Routing", "Losses", "Flow Statistics",
+    "Output", "Checkpoint", "Control Actions"};
+
+//-----------------------------------------------------------------------------
+//  Data Structures
+//-----------------------------------------------------------------------------
+typedef struct TTraceFileName
+{
+    char   name[MAXFNAME+1];
+    int    runs;                       // runs saving to the file
+    int    started;                    // TRUE once the file has been written
+    struct TTraceFileName* next;
+}   TTraceFileName;
+
+//-----------------------------------------------------------------------------
+//  Shared variables
+//-----------------------------------------------------------------------------
+//  Guarded by the swmm_trace critical section; shared by all projects.
+static int TraceTrackCount = 0;              // tracks handed out so far
+static TTraceFileName* TraceFiles = NULL;    // trace files of current runs
+
+//-----------------------------------------------------------------------------
+//  External functions (declared in funcs.h)
+//-----------------------------------------------------------------------------
+//  trace_open               (called by swmm_start in swmm5.c)
+//  trace_close              (called by swmm_end in swmm5.c)
+//  trace_addSpan            (called by perf_stop in perf.c)
+//  trace_addEvent           (called by routing_execute in routing.c)
+
+//-----------------------------------------------------------------------------
+//  Function declarations
+//-----------------------------------------------------------------------------
+static int  growTraceBuffer(TTraceBuffer* trace);
+static TTraceFileName* findTraceFile(char* name);
+static int  addTraceFileRun(char* name);
+static void endTraceFileRun(char* name);
+static int  writeTraceFile(Project *project);
+static void writeJsonString(FILE* f, char* s);
+static void writeEvent(Project *project, FILE* f, TTraceEvent* event);
+
+//=============================================================================
+
+void trace_open(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: allocates the event buffer at the start of a traced run.
+//
+{
+    TTraceBuffer* trace = &project->Trace;
+    double n;
+    int    ok;
+
+    trace->events = NULL;
+    trace->capacity = 0;
+    trace->count = 0;
+    trace->dropped = 0;
+    trace->nonConvergeCount = project->NonConvergeCount;
+    if ( project->Ftrace.mode != SAVE_FILE ) return;
+
+    // --- room for every phase of each step taken at the routing step
+    n = project->TotalDuration / 1000.0 / MAX(project->RouteStep, 0.001);
+    n = (n + 1.0) * (MAX_PERF_PHASES + 1);
+    n = MIN(n, MAX_TRACE_EVENTS);
+    trace->capacity = (int)MAX(n, MIN_TRACE_EVENTS);
+    trace->events = (TTraceEvent *) malloc(trace->capacity * sizeof(TTraceEvent));
+    if ( trace->events == NULL )
+    {
+        trace->capacity = 0;
+        report_writeErrorMsg(project, ERR_MEMORY, "");
+        return;
+    }
+
+#pragma omp critical (swmm_trace)
+    {
+        trace->track = ++TraceTrackCount;
+        ok = addTraceFileRun(project->Ftrace.name);
+    }
+    if ( !ok )
+    {
+        FREE(trace->events);
+        trace->capacity = 0;
+        report_writeErrorMsg(project, ERR_MEMORY, "");
+    }
+}
+
+//=============================================================================
+
+void trace_close(Project *project)
+//
+//  Input:   none
+//  Output:  none
+//  Purpose: writes the recorded events to the trace file and frees them.
+//
+{
+    TTraceBuffer* trace = &project->Trace;
+    int ok;
+
+    if ( trace->events == NULL ) return;
+
+#pragma omp critical (swmm_trace)
+    {
+        ok = writeTraceFile(project);
+        endTraceFileRun(project->Ftrace.name);
+    }
+    if ( !ok ) report_writeErrorMsg(project, ERR_TRACE_FILE_OPEN,
+                                    project->Ftrace.name);
+
+    FREE(trace->events);
+    trace->capacity = 0;
+    trace->count = 0;
+}
+
+//=============================================================================
+
+void trace_addSpan(Project *project, int type, double start, double end,
+                   int count)
+//
+//  Input:   type = a PerfPhaseType code
+//           start = clock time the phase started (sec)
+//           end = clock time the phase ended (sec)
+//           count = number of iterations made by the phase
+//  Output:  none
+//  Purpose: records a timed phase of the simulation.
+//
+{
+    TTraceBuffer* trace = &project->Trace;
+    TTraceEvent*  event;
+
+    if ( trace->count >= trace->capacity && !growTraceBuffer(trace) )
+    {
+        trace->dropped++;
+        return;
+    }
+    event = &trace->events[trace->count++];
+    event->start = start;
+    event->end = end;
+    event->type = type;
+    event->count = count;
+    event->step = 0.0;
+    event->converged = TRUE;
+    if ( type == PERF_FLOW_ROUTING )
+    {
+        event->step = (project->NewRoutingTime - project->OldRoutingTime) / 1000.0;
+        event->converged = project->NonConvergeCount == trace->nonConvergeCount;
+        trace->nonConvergeCount = project->NonConvergeCount;
+    }
+}
+
+//=============================================================================
+
+void trace_addEvent(Project *project, int type, int count)
+//
+//  Input:   type = a TraceEventType code
+//           count = number of items involved (e.g., actions taken)
+//  Output:  none
+//  Purpose: records an instantaneous event if the run is being traced.
+//
+{
+    double now;
+
+    if ( project->Trace.events == NULL ) return;
+    now = omp_get_wtime();
+    trace_addSpan(project, type, now, now, count);
+}
+
+//=============================================================================
+
+int growTraceBuffer(TTraceBuffer* trace)
+//
+//  Input:   trace = a project's trace buffer
+//  Output:  returns TRUE if the buffer has room for another event
+//  Purpose: doubles the size of a full event buffer up to its largest size.
+//
+{
+    TTraceEvent* events;
+    int capacity;
+
+    if ( trace->capacity >= MAX_TRACE_EVENTS ) return FALSE;
+    capacity = MIN(2 * trace->capacity, MAX_TRACE_EVENTS);
+    events = (TTraceEvent *) realloc(trace->events, capacity * sizeof(TTraceEvent));
+    if ( events == NULL ) return FALSE;
+    trace->events = events;
+    trace->capacity = capacity;
+    return TRUE;
+}
+
+//=============================================================================
+
+TTraceFileName* findTraceFile(char* name)
+//
+//  Input:   name = name of a trace file
+//  Output:  returns the file's entry in the list of trace files (or NULL)
+//  Purpose: finds a trace file that current runs save to.
+//
+//  Must be called from within the swmm_trace critical section.
+//
+{
+    TTraceFileName* traceFile;
+
+    for (traceFile = TraceFiles; traceFile; traceFile = traceFile->next)
+    {
+        if ( strcmp(traceFile->name, name) == 0 ) break;
+    }
+    return traceFile;
+}
+
+//=============================================================================
+
+int addTraceFileRun(char* name)
+//
+//  Input:   name = name of a trace file
+//  Output:  returns FALSE if out of memory
+//  Purpose: adds a run that saves to a trace file, listing the file if no
+//           other current run saves to it.
+//
+//  Must be called from within the swmm_trace critical section.
+//
+{
+    TTraceFileName* traceFile = findTraceFile(name);
+
+    if ( traceFile == NULL )
+    {
+        traceFile = (TTraceFileName *) malloc(sizeof(TTraceFileName));
+        if ( traceFile == NULL ) return FALSE;
+        sstrncpy(traceFile->name, name, MAXFNAME);
+        traceFile->runs = 0;
+        traceFile->started = FALSE;
+        traceFile->next = TraceFiles;
+        TraceFiles = traceFile;
+    }
+    traceFile->runs++;
+    return TRUE;
+}
+
+//=============================================================================
+
+void endTraceFileRun(char* name)
+//
+//  Input:   name = name of a trace file
+//  Output:  none
+//  Purpose: removes a run that saved to a trace file, dropping the file
+//           from the list once no run saves to it.
+//
+//  Must be called from within the swmm_trace critical section.
+//
+{
+    TTraceFileName*  traceFile;
+    TTraceFileName** link;
+
+    for (link = &TraceFiles; *link; link = &(*link)->next)
+    {
+        traceFile = *link;
+        if ( strcmp(traceFile->name, name) != 0 ) continue;
+        traceFile->runs--;
+        if ( traceFile->runs <= 0 )
+        {
+            *link = traceFile->next;
+            free(traceFile);
+        }
+        return;
+    }
+}
+
+//=============================================================================
+
+int writeTraceFile(Project *project)
+//
+//  Input:   none
+//  Output:  returns TRUE if successful
+//  Purpose: writes a project's events to its trace file, adding them to
+//           the file if another current run of this process started it.
+//
+//  Must be called from within the swmm_trace critical section.
+//
+{
+    TTraceBuffer*   trace = &project->Trace;
+    TTraceFileName* traceFile = findTraceFile(project->Ftrace.name);
+    FILE* f = NULL;
+    int   i;
+
+    if ( traceFile == NULL ) return FALSE;
+
+    // --- a started file ends with "\n]\n", which the new events replace
+    if ( traceFile->started )
+    {
+        f = fopen(project->Ftrace.name, "r+b");
+        if ( f && fseek(f, -3, SEEK_END) != 0 )
+        {
+            fclose(f);
+            f = NULL;
+        }
+        if ( f == NULL ) return FALSE;
+        fprintf(f, ",\n");
+    }
+    else
+    {
+        f = fopen(project->Ftrace.name, "wb");
+        if ( f == NULL ) return FALSE;
+        traceFile->started = TRUE;
+        fprintf(f, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                   "\"args\":{\"name\":\"SWMM\"}},\n");
+    }
+
+    // --- name the project's track after its input file
+    fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+               "\"args\":{\"name\":", trace->track);
+    writeJsonString(f, project->Finp.name);
+    fprintf(f, "}},\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,"
+               "\"tid\":%d,\"args\":{\"sort_index\":%d}}", trace->track,
+               trace->track);
+
+    for (i = 0; i < trace->count; i++)
+    {
+        fprintf(f, ",\n");
+        writeEvent(project, f, &trace->events[i]);
+    }
+
+    // --- note events that did not fit in the buffer
+    if ( trace->dropped > 0 && trace->count > 0 )
+    {
+        fprintf(f, ",\n{\"name\":\"Trace Buffer Full\",\"ph\":\"i\",\"s\":\"t\","
+                   "\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"dropped\":%ld}}",
+                   trace->track, trace->events[trace->count-1].end * 1.0e6,
+                   trace->dropped);
+    }
+    fprintf(f, "\n]\n");
+    i = ferror(f);
+    if ( fclose(f) != 0 ) i = TRUE;
+    return !i;
+}
+
+//=============================================================================
+
+void writeEvent(Project *project, FILE* f, TTraceEvent* event)
+//
+//  Input:   f = trace file
+//           event = a recorded event
+//  Output:  none
+//  Purpose: writes an event as a trace event JSON object.
+//
+{
+    if ( event->type == TRACE_CONTROL_ACTIONS )
+    {
+        fprintf(f, "{\"name\":\"%s\",\"cat\":\"controls\",\"ph\":\"i\","
+                   "\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                   "\"args\":{\"actions\":%d}}", TraceEventNames[event->type],
+                   project->Trace.track, event->start * 1.0e6, event->count);
+        return;
+    }
+
+    fprintf(f, "{\"name\":\"%s\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,"
+               "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+               TraceEventNames[event->type], project->Trace.track,
+               event->start * 1.0e6, (event->end - event->start) * 1.0e6);
+
+    // --- flow routing steps that failed to converge or were cut to the
+    //     minimum variable step are colored so they stand out
+    if ( event->type == PERF_FLOW_ROUTING )
+    {
+        if ( !event->converged ) fprintf(f, ",\"cname\":\"terrible\"");
+        else if ( project->RouteModel == DW && project->CourantFactor > 0.0
+        &&   event->step <= project->MinRouteStep ) fprintf(f, ",\"cname\":\"bad\"");
+        fprintf(f, ",\"args\":{\"iterations\":%d,\"step\":%g,\"converged\":%s}}",
+                event->count, event->step, event->converged ? "true" : "false");
+    }
+    else if ( event->count > 0 )
+        fprintf(f, ",\"args\":{\"iterations\":%d}}", event->count);
+    else fprintf(f, "}");
+}
+
+//=============================================================================
+
+void writeJsonString(FILE* f, char* s)
+//
+//  Input:   f = trace file
+//           s = a string
+//  Output:  none
+//  Purpose: writes a string as a quoted JSON string.
+//
+{
+    fputc('"', f);
+    for ( ; *s; s++ )
+    {
+        if ( *s == '"' || *s == '\\' ) fprintf(f, "\\%c", *s);
+        else if ( (unsigned char)*s < 0x20 ) fprintf(f, "\\u%04x", *s);
+        else fputc(*s, f);
+    }
+    fputc('"', f);
+}
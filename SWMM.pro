@@ -39,13 +39,25 @@ INCLUDEPATH += ./include \
 
 HEADERS +=./include/stdafx.h \
           ./include/dataexchangecache.h \
+          ./include/checkpointwriter.h \
           ./test/include/swmmtestclass.h \
+          ./test/include/swmmbenchmarkclass.h \
+          ./test/include/swmmnetworkgenerator.h \
+          ./test/include/swmmscalingbenchmarkclass.h \
+          ./test/include/swmmprocessmemory.h \
+          ./test/include/swmmregressionclass.h \
           ./include/couplingdatacache.h
 
 SOURCES +=./src/stdafx.cpp \
           ./src/dataexchangecache.cpp \
+          ./src/checkpointwriter.cpp \
           ./test/src/swmmtestdriver.cpp \
-          ./test/src/swmmtestclass.cpp
+          ./test/src/swmmtestclass.cpp \
+          ./test/src/swmmbenchmarkclass.cpp \
+          ./test/src/swmmnetworkgenerator.cpp \
+          ./test/src/swmmscalingbenchmarkclass.cpp \
+          ./test/src/swmmprocessmemory.cpp \
+          ./test/src/swmmregressionclass.cpp
 
 message("SWMM Version: " $$VERSION)
 
@@ -103,9 +115,12 @@ SOURCES += ./$$VERSION/src/climate.c \
            ./$$VERSION/src/massbal.c \
            ./$$VERSION/src/mathexpr.c \
            ./$$VERSION/src/mempool.c \
+           ./$$VERSION/src/memuse.c \
            ./$$VERSION/src/node.c \
            ./$$VERSION/src/odesolve.c \
            ./$$VERSION/src/output.c \
+           ./$$VERSION/src/perf.c \
+           ./$$VERSION/src/progress.c \
            ./$$VERSION/src/project.c \
            ./$$VERSION/src/qualrout.c \
            ./$$VERSION/src/rain.c \
@@ -115,6 +130,7 @@ SOURCES += ./$$VERSION/src/climate.c \
            ./$$VERSION/src/routing.c \
            ./$$VERSION/src/runoff.c \
            ./$$VERSION/src/shape.c \
+           ./$$VERSION/src/snapshot.c \
            ./$$VERSION/src/snow.c \
            ./$$VERSION/src/stats.c \
            ./$$VERSION/src/statsrpt.c \
@@ -123,6 +139,7 @@ SOURCES += ./$$VERSION/src/climate.c \
            ./$$VERSION/src/swmm5.c \
            ./$$VERSION/src/table.c \
            ./$$VERSION/src/toposort.c \
+           ./$$VERSION/src/trace.c \
            ./$$VERSION/src/transect.c \
            ./$$VERSION/src/treatmnt.c \
            ./$$VERSION/src/xsect.c \
@@ -153,6 +170,9 @@ macx{
       message("OpenMP disabled")
      }
 
+    #Lets the coupling exchange kernels vectorize calls to sqrt
+    QMAKE_CXXFLAGS += -fno-math-errno -fno-trapping-math
+
     contains(DEFINES,USE_MPI){
 
         QMAKE_CC = /usr/local/bin/mpicc
@@ -183,6 +203,9 @@ linux{
 
         message("OpenMP disabled")
      }
+
+    #Lets the coupling exchange kernels vectorize calls to sqrt
+    QMAKE_CXXFLAGS += -fno-math-errno -fno-trapping-math
 }
 
 win32{
@@ -0,0 +1,41 @@
+#Author Caleb Amoa Buahin
+#Email caleb.buahin@gmail.com
+#Date 2018
+#License GNU Lesser General Public License (see <http: //www.gnu.org/licenses/> for details).
+#Writes synthetic SWMM input files of any size for the scaling benchmarks
+
+TEMPLATE = app
+TARGET = SWMMNetworkGenerator
+CONFIG += console c++11
+CONFIG -= qt app_bundle
+CONFIG += debug_and_release
+
+DEFINES += SWMM_TEST
+
+INCLUDEPATH += ./test/include
+
+HEADERS += ./test/include/swmmnetworkgenerator.h
+
+SOURCES += ./test/src/swmmnetworkgenerator.cpp \
+           ./test/src/swmmnetworkgeneratormain.cpp
+
+CONFIG(debug, debug|release) {
+   DESTDIR = ./build/debug
+   OBJECTS_DIR = $$DESTDIR/.obj
+}
+
+CONFIG(release, debug|release) {
+    OBJECTS_DIR = ./build/release/.obj
+
+    macx{
+        DESTDIR = bin/macx
+     }
+
+    linux{
+        DESTDIR = bin/linux
+     }
+
+    win32{
+        DESTDIR = bin/win32
+     }
+}
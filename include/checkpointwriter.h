@@ -0,0 +1,58 @@
+/*!
+ * \file checkpointwriter.h
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version SWMM 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+
+#ifndef CHECKPOINTWRITER_H
+#define CHECKPOINTWRITER_H
+
+#include <stddef.h>
+
+typedef struct Project Project;
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+//-----------------------------------------------------------------------------
+//   Checkpoint writer
+//-----------------------------------------------------------------------------
+//   Writes images of the output hot start file on a background thread so
+//   that a simulation does not wait on disk while saving checkpoints. Each
+//   image is written to a temporary file that then replaces fileName, so
+//   fileName always holds a complete checkpoint. If a new image is queued
+//   before the previous one was written, the older one is dropped.
+
+int startCheckpointWriter(Project* project, const char* fileName);
+
+//takes ownership of data, which must have been allocated with malloc
+void queueCheckpoint(Project* project, char* data, size_t size);
+
+//writes any queued image and returns 0 if a write failed
+int stopCheckpointWriter(Project* project);
+
+//bytes held by the writer, including an image waiting to be written
+size_t getCheckpointWriterSize(Project* project);
+
+#ifdef __cplusplus
+}   // matches the linkage specification from above */
+#endif
+
+#endif // CHECKPOINTWRITER_H
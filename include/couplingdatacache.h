@@ -1,15 +1,331 @@
 #ifndef COUPLINGDATACACHE_H
 #define COUPLINGDATACACHE_H
 
-#include <unordered_map>
+#include <vector>
+#include <atomic>
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/*!
+ * \brief The CouplingValues struct holds one value per model element in a dense array
+ * together with a bitset marking which elements currently have a value.
+ */
+struct CouplingValues
+{
+    std::vector<double> Values;
+    std::vector<uint64_t> Present;
+
+    void resize(int count)
+    {
+      Values.assign(count, 0.0);
+      Present.assign((count + 63) / 64, 0);
+    }
+
+    int size() const
+    {
+      return (int)Values.size();
+    }
+
+    bool contains(int index) const
+    {
+      return index >= 0 && index < size() &&
+          (Present[index >> 6] >> (index & 63)) & 1;
+    }
+
+    void set(int index, double value)
+    {
+      if(index < 0 || index >= size())
+        return;
+
+      Values[index] = value;
+      Present[index >> 6] |= (uint64_t)1 << (index & 63);
+    }
+
+    void add(int index, double value)
+    {
+      if(index < 0 || index >= size())
+        return;
+
+      if(contains(index))
+        Values[index] += value;
+      else
+        set(index, value);
+    }
+
+    int remove(int index)
+    {
+      if(!contains(index))
+        return 0;
+
+      Values[index] = 0.0;
+      Present[index >> 6] &= ~((uint64_t)1 << (index & 63));
+      return 1;
+    }
+
+    void clear()
+    {
+      for(size_t w = 0; w < Present.size(); w++)
+      {
+        uint64_t word = Present[w];
+
+        while(word)
+        {
+          Values[w * 64 + lowestBit(word)] = 0.0;
+          word &= word - 1;
+        }
+
+        Present[w] = 0;
+      }
+    }
+
+    /*!
+     * \brief forEach calls func(index, value) for every element that has a value,
+     * in order of element index.
+     */
+    template<typename Func>
+    void forEach(Func func) const
+    {
+      for(size_t w = 0; w < Present.size(); w++)
+      {
+        uint64_t word = Present[w];
+
+        while(word)
+        {
+          int index = (int)(w * 64) + lowestBit(word);
+          func(index, Values[index]);
+          word &= word - 1;
+        }
+      }
+    }
+
+    static int lowestBit(uint64_t word)
+    {
+#ifdef _MSC_VER
+      unsigned long bit;
+      _BitScanForward64(&bit, word);
+      return (int)bit;
+#else
+      return __builtin_ctzll(word);
+#endif
+    }
+};
+
+/*!
+ * \brief The CouplingExchangeSlot struct passes values from one producer thread to
+ * SWMM through two buffers. The buffer for epoch e is Buffers[e & 1]. The producer
+ * may fill epoch Published + 1 once SWMM has consumed epoch Published - 1, so it can
+ * write the next step's values while SWMM is still reading the current ones.
+ */
+struct CouplingExchangeSlot
+{
+    CouplingExchangeSlot() : Published(0), Consumed(0), Writing(false) {}
+
+    CouplingValues Buffers[2];
+    std::atomic<unsigned int> Published;
+    std::atomic<unsigned int> Consumed;
+    bool Writing; //only used by the producer
+
+    void resize(int count)
+    {
+      Buffers[0].resize(count);
+      Buffers[1].resize(count);
+      Published.store(0);
+      Consumed.store(0);
+      Writing = false;
+    }
+
+    //producer side
+    CouplingValues *beginWrite()
+    {
+      unsigned int published = Published.load(std::memory_order_relaxed);
+
+      if(published > Consumed.load(std::memory_order_acquire) + 1)
+        return nullptr;
+
+      CouplingValues *buffer = &Buffers[(published + 1) & 1];
+      buffer->clear();
+      Writing = true;
+      return buffer;
+    }
+
+    CouplingValues *writeBuffer()
+    {
+      if(!Writing)
+        return nullptr;
+
+      return &Buffers[(Published.load(std::memory_order_relaxed) + 1) & 1];
+    }
+
+    unsigned int publish()
+    {
+      unsigned int published = Published.load(std::memory_order_relaxed);
+
+      if(Writing)
+      {
+        Writing = false;
+        Published.store(++published, std::memory_order_release);
+      }
+
+      return published;
+    }
+
+    //consumer side
+    bool receive(CouplingValues &target)
+    {
+      unsigned int published = Published.load(std::memory_order_acquire);
+
+      if(published == Consumed.load(std::memory_order_relaxed))
+        return false;
+
+      target.clear();
+      Buffers[published & 1].forEach([&target](int index, double value)
+      {
+        target.set(index, value);
+      });
+
+      Consumed.store(published, std::memory_order_release);
+      return true;
+    }
+};
+
+struct CouplingSample
+{
+    double Time;
+    double Value;
+};
+
+/*!
+ * \brief The CouplingSampleSeries struct holds timestamped samples of one coupling
+ * variable for each model element and interpolates them linearly to the current
+ * routing time, holding the first and last samples outside their range.
+ */
+struct CouplingSampleSeries
+{
+    std::vector<std::vector<CouplingSample>> Samples;
+    CouplingValues Current; //interpolated values; marks elements with samples
+
+    void resize(int count)
+    {
+      Samples.assign(count, std::vector<CouplingSample>());
+      Current.resize(count);
+    }
+
+    //samples at or after time are replaced
+    void add(int index, double time, double value)
+    {
+      if(index < 0 || index >= Current.size())
+        return;
+
+      std::vector<CouplingSample> &samples = Samples[index];
+
+      while(!samples.empty() && samples.back().Time >= time)
+        samples.pop_back();
+
+      CouplingSample sample = {time, value};
+      samples.push_back(sample);
+
+      if(!Current.contains(index))
+        Current.set(index, value);
+    }
+
+    void clear()
+    {
+      Current.forEach([this](int index, double)
+      {
+        Samples[index].clear();
+      });
+
+      Current.clear();
+    }
+
+    void interpolate(double time)
+    {
+      Current.forEach([this, time](int index, double)
+      {
+        std::vector<CouplingSample> &samples = Samples[index];
+        size_t k = 0;
+
+        while(k < samples.size() && samples[k].Time < time)
+          k++;
+
+        double value;
+
+        if(k == 0)
+          value = samples[0].Value;
+        else if(k == samples.size())
+          value = samples[k - 1].Value;
+        else
+        {
+          const CouplingSample &s1 = samples[k - 1];
+          const CouplingSample &s2 = samples[k];
+          value = s1.Value + (s2.Value - s1.Value) * (time - s1.Time) / (s2.Time - s1.Time);
+        }
+
+        //samples before the one bracketing time are no longer needed
+        if(k > 1)
+          samples.erase(samples.begin(), samples.begin() + (k - 1));
+
+        Current.Values[index] = value;
+      });
+    }
+};
+
+/*!
+ * \brief The CouplingStateAverage struct accumulates the time integral of one state
+ * variable of every element since averaging was last started.
+ */
+struct CouplingStateAverage
+{
+    CouplingStateAverage() : Active(false), Duration(0.0) {}
+
+    bool Active;
+    double Duration; //seconds
+    std::vector<double> Sums;
+};
+
+/*!
+ * \brief The CouplingRainfallGrid struct holds the sparse grid cell to subcatchment
+ * weight matrix in compressed sparse row form, one row per subcatchment.
+ */
+struct CouplingRainfallGrid
+{
+    CouplingRainfallGrid() : CellCount(0), RowCount(0) {}
+
+    int CellCount;
+    int RowCount; //number of subcatchments with at least one weight
+    std::vector<int> RowStart;
+    std::vector<int> Cells;
+    std::vector<double> Weights;
+    std::vector<uint64_t> Rows; //bitset of subcatchments with at least one weight
+
+    void clear()
+    {
+      CellCount = 0;
+      RowCount = 0;
+      RowStart.clear();
+      Cells.clear();
+      Weights.clear();
+      Rows.clear();
+    }
+};
 
 struct CouplingDataCache
 {
     CouplingDataCache(){}
-    std::unordered_map<int,double> NodeLateralInflows;
-    std::unordered_map<int,double> NodeDepths;
-    std::unordered_map<int,double> SubcatchRainfall;
-    std::unordered_map<int,double> XSections;
+    CouplingValues NodeLateralInflows;
+    CouplingValues NodeDepths;
+    CouplingValues SubcatchRainfall;
+    CouplingValues XSections;
+    CouplingExchangeSlot NodeLateralInflowSlot;
+    CouplingExchangeSlot NodeDepthSlot;
+    std::vector<double> SurfaceExchangeWork; //gathered node properties for computeSurfaceExchange
+    CouplingRainfallGrid RainfallGrid;
+    CouplingSampleSeries NodeLateralInflowSamples;
+    CouplingSampleSeries NodeDepthSamples;
+    std::vector<CouplingStateAverage> StateAverages; //one per CouplingStateType
 };
 
 #endif // COUPLINGDATACACHE_H
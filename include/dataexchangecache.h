@@ -41,6 +41,8 @@
 
 
 
+#include <stddef.h>
+
 typedef struct Project Project;
 
 
@@ -52,6 +54,9 @@ extern "C"
 
 void initializeCouplingDataCache(Project* project);
 
+//bytes held by the coupling data cache
+size_t getCouplingDataCacheSize(Project* project);
+
 void DLLEXPORT addNodeLateralInflow(Project* project, int index, double value);
 int DLLEXPORT containsNodeLateralInflow(Project* project, int index, double* value);
 int DLLEXPORT removeNodeLateralInflow(Project* project, int index);
@@ -64,6 +69,188 @@ void DLLEXPORT addSubcatchRain(Project* project, int index, double value);
 int DLLEXPORT containsSubcatchRain(Project* project, int index, double* value);
 int DLLEXPORT removeSubcatchRain(Project* project, int index);
 
+//-----------------------------------------------------------------------------
+//   Bulk exchange functions
+//-----------------------------------------------------------------------------
+//   Each takes count (index, value) pairs. Indexes outside the range of
+//   the element type are ignored. The get functions leave values for
+//   indexes without a cached value unchanged and return the number of
+//   indexes that had one.
+
+void DLLEXPORT addNodeLateralInflows(Project* project, int count, const int* indexes, const double* values);
+int DLLEXPORT getNodeLateralInflows(Project* project, int count, const int* indexes, double* values);
+
+void DLLEXPORT addNodeDepths(Project* project, int count, const int* indexes, const double* values);
+int DLLEXPORT getNodeDepths(Project* project, int count, const int* indexes, double* values);
+
+void DLLEXPORT addSubcatchRains(Project* project, int count, const int* indexes, const double* values);
+int DLLEXPORT getSubcatchRains(Project* project, int count, const int* indexes, double* values);
+
+//-----------------------------------------------------------------------------
+//   Rainfall grids
+//-----------------------------------------------------------------------------
+//   Maps a gridded rainfall product (e.g. radar) onto subcatchments through
+//   a sparse weight matrix with one row per subcatchment, stored in
+//   compressed sparse row form: the weights for subcatchment j are
+//   weights[rowStart[j]] .. weights[rowStart[j+1] - 1] applied to grid
+//   cells cells[rowStart[j]] .. and rowStart has Nobjects[SUBCATCH] + 1
+//   entries. setRainfallGridOverlaps builds the same matrix from (subcatch,
+//   cell, overlap area) triplets, weighting each cell by its share of the
+//   subcatchment's total overlap. Both return the number of subcatchments
+//   on the grid, or -1 (leaving no grid) if an index is out of range.
+//   applyRainfallGrid takes one rainfall intensity (in/hr or mm/hr) per
+//   cell and sets the cached rainfall of every subcatchment on the grid,
+//   which is then used in place of its rain gage's until the next frame
+//   or clearDataCache. It returns the number of subcatchments set.
+
+int DLLEXPORT setRainfallGridWeights(Project* project, int cellCount, const int* rowStart,
+                                     const int* cells, const double* weights);
+int DLLEXPORT setRainfallGridOverlaps(Project* project, int cellCount, int count, const int* subcatchs,
+                                      const int* cells, const double* areas);
+int DLLEXPORT applyRainfallGrid(Project* project, const double* cellRainfall);
+
+//-----------------------------------------------------------------------------
+//   State views
+//-----------------------------------------------------------------------------
+//   A view gives read-only access to one state variable of every node,
+//   link or subcatchment without copying: the value for element i is the
+//   double at (const char*)view.data + i * view.stride. Values are in the
+//   model's internal units (ft, cfs) and are current after each swmm_step.
+//   Views stay valid from swmm_start until swmm_close. getStateView
+//   returns 1 if the view was filled and 0 if the type has no view.
+//   copyStateValues copies count values starting at element start into
+//   values and returns the number copied (0 if start is negative).
+
+enum CouplingStateType {
+      COUPLING_NODE_DEPTH,             // node water depth (ft)
+      COUPLING_NODE_HEAD,              // node hydraulic head (ft), copy only
+      COUPLING_NODE_INFLOW,            // node total inflow (cfs)
+      COUPLING_NODE_OVERFLOW,          // node surcharge overflow/inflow (cfs)
+      COUPLING_LINK_FLOW,              // link flow rate (cfs)
+      COUPLING_LINK_DEPTH,             // link flow depth (ft)
+      COUPLING_SUBCATCH_RUNOFF};       // subcatchment runoff (cfs)
+
+typedef struct
+{
+    const double* data;                // value for first element
+    int           stride;              // bytes between successive values
+    int           count;               // number of elements
+} CouplingStateView;
+
+int DLLEXPORT getStateView(Project* project, int type, CouplingStateView* view);
+int DLLEXPORT copyStateValues(Project* project, int type, int start, int count, double* values);
+
+//-----------------------------------------------------------------------------
+//   Timestamped samples
+//-----------------------------------------------------------------------------
+//   Let a coupled model supply values at its own exchange times instead of
+//   driving SWMM to each of them. time is elapsed simulation time in
+//   decimal days, as returned by swmm_step. At each routing step SWMM
+//   interpolates an element's samples linearly to the end of the step,
+//   holding the first and last samples outside their range, and applies
+//   the result in addition to (lateral inflows) or in place of (depths)
+//   the cached values. Samples are kept until clearCouplingSamples rather
+//   than clearDataCache; adding a sample discards that element's samples
+//   at or after its time, and samples no longer needed are dropped as the
+//   simulation advances.
+
+void DLLEXPORT addNodeLateralInflowSample(Project* project, int index, double time, double value);
+void DLLEXPORT addNodeLateralInflowSamples(Project* project, double time, int count, const int* indexes, const double* values);
+
+void DLLEXPORT addNodeDepthSample(Project* project, int index, double time, double value);
+void DLLEXPORT addNodeDepthSamples(Project* project, double time, int count, const int* indexes, const double* values);
+
+void DLLEXPORT clearCouplingSamples(Project* project);
+
+//-----------------------------------------------------------------------------
+//   State averaging
+//-----------------------------------------------------------------------------
+//   startStateAveraging (re)starts accumulating the time average over
+//   routing steps of a CouplingStateType and returns 0 if the
+//   type is not valid. getAveragedStateValues copies the averages of count
+//   elements starting at element start into values, sets duration to the
+//   seconds averaged over and returns the number copied (0 if start is
+//   negative); until a routing step has been taken it copies the current
+//   values. Multiplying an average flow by duration gives the volume
+//   since the last exchange. stopStateAveraging stops accumulating.
+//   Restoring a saved state (swmm_restoreState) restarts every active
+//   average, so it never includes the steps that were rolled back.
+
+int DLLEXPORT startStateAveraging(Project* project, int type);
+int DLLEXPORT getAveragedStateValues(Project* project, int type, int start, int count, double* values, double* duration);
+void DLLEXPORT stopStateAveraging(Project* project, int type);
+
+//-----------------------------------------------------------------------------
+//   State vectors
+//-----------------------------------------------------------------------------
+//   Move the hydraulic state in and out of a model as one dense vector,
+//   e.g. for ensemble data assimilation. parts is a sum of
+//   CouplingStateVectorPart values; the vector holds one block per part
+//   in the order of the enum, each with one value per node, link or
+//   subcatchment in index order, in internal units. Subcatchments without
+//   groundwater have a level of 0 that is ignored when scattered.
+//   getStateVectorSize returns the vector length and getStateVectorOffset
+//   the start of a part's block (-1 if it is not in parts). Gather and
+//   scatter return the vector length and should be called between steps.
+//   Scattering keeps each node's volume consistent with its depth: when
+//   depths are scattered volumes are recomputed from them, otherwise
+//   scattered volumes set the depths of storage units (other nodes hold
+//   no volume of their own). Scattered link depths likewise set conduit
+//   flow areas and volumes. The ensemble functions gather or
+//   scatter count members in parallel, member m using the vector at
+//   x + m * getStateVectorSize.
+
+enum CouplingStateVectorPart {
+      STATE_VECTOR_NODE_DEPTH  = 1,    // node water depth (ft)
+      STATE_VECTOR_NODE_VOLUME = 2,    // node stored volume (ft3)
+      STATE_VECTOR_LINK_FLOW   = 4,    // link flow rate (cfs)
+      STATE_VECTOR_LINK_DEPTH  = 8,    // link flow depth (ft)
+      STATE_VECTOR_GW_LEVEL    = 16};  // groundwater table elevation (ft)
+
+int DLLEXPORT getStateVectorSize(Project* project, int parts);
+int DLLEXPORT getStateVectorOffset(Project* project, int parts, int part);
+int DLLEXPORT gatherStateVector(Project* project, int parts, double* x);
+int DLLEXPORT scatterStateVector(Project* project, int parts, const double* x);
+int DLLEXPORT gatherEnsembleStateVectors(Project** members, int count, int parts, double* x);
+int DLLEXPORT scatterEnsembleStateVectors(Project** members, int count, int parts, const double* x);
+
+//-----------------------------------------------------------------------------
+//   Exchange slots
+//-----------------------------------------------------------------------------
+//   Let one external thread publish values for a coupling variable while
+//   SWMM is stepping on another thread. The producer calls beginExchange
+//   (which returns 0 while SWMM still holds both buffers), then
+//   setExchangeValues, then publishExchange (both do nothing unless
+//   beginExchange succeeded). SWMM applies the most recently
+//   published values in place of the cached ones the next time it applies
+//   that variable. Only exchange functions may be called from the producer
+//   thread; the cache functions above remain for the thread that steps SWMM.
+
+enum CouplingExchangeType {
+      EXCHANGE_NODE_LATERAL_INFLOW,    // replaces node lateral inflows (cfs)
+      EXCHANGE_NODE_DEPTH};            // replaces node depths (ft)
+
+int DLLEXPORT beginExchange(Project* project, int type);
+void DLLEXPORT setExchangeValues(Project* project, int type, int count, const int* indexes, const double* values);
+unsigned int DLLEXPORT publishExchange(Project* project, int type);
+unsigned int DLLEXPORT getExchangeEpoch(Project* project, int type, unsigned int* consumed);
+
+//-----------------------------------------------------------------------------
+//   Surface-sewer exchange
+//-----------------------------------------------------------------------------
+//   Computes the flow between a 2D surface model and each listed manhole
+//   from the surface water elevation above it (ft), using the node's
+//   inlet area, perimeter and orificeDischargeCoeff. While the sewer head
+//   is below the rim, inflow is the lesser of free weir flow over the
+//   perimeter and orifice flow through the inlet area. Once the node is
+//   surcharged, flow passes through the inlet as a submerged orifice in
+//   either direction. Flows (cfs, positive into the sewer) are added to
+//   the cached node lateral inflows and, if flows is not NULL, returned.
+//   Returns the number of valid node indexes processed.
+
+int DLLEXPORT computeSurfaceExchange(Project* project, int count, const int* nodes,
+                                     const double* surfaceElevs, double* flows);
+
 void DLLEXPORT clearDataCache(Project *project);
 
 void DLLEXPORT disposeCoupledDataCache(Project* project);
@@ -76,6 +263,12 @@ void DLLEXPORT applyCouplingNodeDepths(Project* project);
 
 void DLLEXPORT applyCouplingLateralInflows(Project* project);
 
+int DLLEXPORT isCouplingRaining(Project* project);
+
+void DLLEXPORT accumulateCouplingStates(Project* project, double tStep);
+
+void DLLEXPORT resetCouplingStateAverages(Project* project);
+
 
 #ifdef __cplusplus
 }   // matches the linkage specification from above */
@@ -0,0 +1,179 @@
+/*!
+ * \file checkpointwriter.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version SWMM 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+
+#include "stdafx.h"
+
+
+
+#include "checkpointwriter.h"
+#include "headers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+
+using namespace std;
+
+struct CheckpointWriter
+{
+    CheckpointWriter() : Pending(nullptr), PendingSize(0), Stopping(false), Failed(false) {}
+
+    string FileName;
+    string TempFileName;
+    thread Worker;
+    mutex Lock;
+    condition_variable Ready;
+    char* Pending; //image waiting to be written
+    size_t PendingSize;
+    bool Stopping;
+    bool Failed;
+};
+
+static bool writeCheckpointFile(CheckpointWriter* writer, const char* data, size_t size)
+{
+  FILE* file = fopen(writer->TempFileName.c_str(), "wb");
+
+  if(file == nullptr)
+    return false;
+
+  bool written = fwrite(data, 1, size, file) == size;
+  written = fclose(file) == 0 && written;
+
+  if(!written)
+  {
+    remove(writer->TempFileName.c_str());
+    return false;
+  }
+
+#ifdef _WIN32
+  //rename does not replace an existing file on Windows
+  remove(writer->FileName.c_str());
+#endif
+
+  return rename(writer->TempFileName.c_str(), writer->FileName.c_str()) == 0;
+}
+
+static void runCheckpointWriter(CheckpointWriter* writer)
+{
+  unique_lock<mutex> lock(writer->Lock);
+
+  while(true)
+  {
+    writer->Ready.wait(lock, [writer]{ return writer->Pending || writer->Stopping; });
+
+    if(writer->Pending == nullptr)
+      break;
+
+    char* data = writer->Pending;
+    size_t size = writer->PendingSize;
+    writer->Pending = nullptr;
+
+    lock.unlock();
+    bool written = writeCheckpointFile(writer, data, size);
+    free(data);
+    lock.lock();
+
+    if(!written)
+      writer->Failed = true;
+  }
+}
+
+int startCheckpointWriter(Project* project, const char* fileName)
+{
+  if(project->checkpointWriter)
+    stopCheckpointWriter(project);
+
+  CheckpointWriter* writer = new CheckpointWriter();
+  writer->FileName = fileName;
+  writer->TempFileName = writer->FileName + ".tmp";
+
+  try
+  {
+    writer->Worker = thread(runCheckpointWriter, writer);
+  }
+  catch(const system_error &)
+  {
+    delete writer;
+    return 0;
+  }
+
+  project->checkpointWriter = writer;
+  return 1;
+}
+
+void queueCheckpoint(Project* project, char* data, size_t size)
+{
+  CheckpointWriter* writer = (CheckpointWriter*)project->checkpointWriter;
+
+  if(writer == nullptr)
+  {
+    free(data);
+    return;
+  }
+
+  {
+    lock_guard<mutex> lock(writer->Lock);
+    free(writer->Pending);
+    writer->Pending = data;
+    writer->PendingSize = size;
+  }
+
+  writer->Ready.notify_one();
+}
+
+size_t getCheckpointWriterSize(Project* project)
+{
+  CheckpointWriter* writer = (CheckpointWriter*)project->checkpointWriter;
+
+  if(writer == nullptr)
+    return 0;
+
+  lock_guard<mutex> lock(writer->Lock);
+
+  return sizeof(CheckpointWriter) + writer->FileName.capacity() +
+      writer->TempFileName.capacity() + (writer->Pending ? writer->PendingSize : 0);
+}
+
+int stopCheckpointWriter(Project* project)
+{
+  CheckpointWriter* writer = (CheckpointWriter*)project->checkpointWriter;
+
+  if(writer == nullptr)
+    return 1;
+
+  {
+    lock_guard<mutex> lock(writer->Lock);
+    writer->Stopping = true;
+  }
+
+  writer->Ready.notify_one();
+  writer->Worker.join();
+
+  int failed = writer->Failed;
+  delete writer;
+  project->checkpointWriter = nullptr;
+
+  return !failed;
+}
@@ -28,12 +28,54 @@
 #include "funcs.h"
 #include "couplingdatacache.h"
 
-#include <unordered_map>
+#include <algorithm>
+#include <math.h>
 
 typedef struct OpenMIDataCache OpenMIDataCache;
 
 using namespace std;
 
+static int containsValue(const CouplingValues &values, int index, double* const value)
+{
+  if (values.contains(index))
+  {
+    *value = values.Values[index];
+    return 1;
+  }
+
+  return 0;
+}
+
+static int getValues(const CouplingValues &values, int count, const int* indexes, double* values_out)
+{
+  int found = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    found += containsValue(values, indexes[i], &values_out[i]);
+  }
+
+  return found;
+}
+
+static CouplingExchangeSlot* getExchangeSlot(Project* project, int type)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if (couplingDataCache == nullptr)
+    return nullptr;
+
+  switch (type)
+  {
+    case EXCHANGE_NODE_LATERAL_INFLOW:
+      return &couplingDataCache->NodeLateralInflowSlot;
+    case EXCHANGE_NODE_DEPTH:
+      return &couplingDataCache->NodeDepthSlot;
+    default:
+      return nullptr;
+  }
+}
+
 void initializeCouplingDataCache(Project *project)
 {
   if(project->couplingDataCache == nullptr)
@@ -41,125 +83,864 @@ void initializeCouplingDataCache(Project *project)
     CouplingDataCache* couplingDataCache = new CouplingDataCache();
     project->couplingDataCache = couplingDataCache;
 
-    int max = project->Nobjects[NODE];
+    couplingDataCache->NodeLateralInflows.resize(project->Nobjects[NODE]);
+    couplingDataCache->NodeDepths.resize(project->Nobjects[NODE]);
+    couplingDataCache->SubcatchRainfall.resize(project->Nobjects[SUBCATCH]);
+    couplingDataCache->XSections.resize(project->Nobjects[LINK]);
+    couplingDataCache->NodeLateralInflowSlot.resize(project->Nobjects[NODE]);
+    couplingDataCache->NodeDepthSlot.resize(project->Nobjects[NODE]);
+    couplingDataCache->NodeLateralInflowSamples.resize(project->Nobjects[NODE]);
+    couplingDataCache->NodeDepthSamples.resize(project->Nobjects[NODE]);
+    couplingDataCache->StateAverages.resize(COUPLING_SUBCATCH_RUNOFF + 1);
+  }
+}
 
-    for (int j = 0; j < max; j++)
-    {
-      couplingDataCache->NodeLateralInflows[j] = 0.0;
-    }
+template<typename T>
+static size_t vectorBytes(const std::vector<T> &values)
+{
+  return values.capacity() * sizeof(T);
+}
+
+static size_t valuesBytes(const CouplingValues &values)
+{
+  return vectorBytes(values.Values) + vectorBytes(values.Present);
+}
+
+static size_t samplesBytes(const CouplingSampleSeries &series)
+{
+  size_t size = vectorBytes(series.Samples) + valuesBytes(series.Current);
+
+  for(const std::vector<CouplingSample> &samples : series.Samples)
+    size += vectorBytes(samples);
+
+  return size;
+}
+
+size_t getCouplingDataCacheSize(Project* project)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if (couplingDataCache == nullptr)
+    return 0;
+
+  const CouplingRainfallGrid &grid = couplingDataCache->RainfallGrid;
+  size_t size = sizeof(CouplingDataCache);
+
+  size += valuesBytes(couplingDataCache->NodeLateralInflows);
+  size += valuesBytes(couplingDataCache->NodeDepths);
+  size += valuesBytes(couplingDataCache->SubcatchRainfall);
+  size += valuesBytes(couplingDataCache->XSections);
+
+  for(int i = 0; i < 2; i++)
+  {
+    size += valuesBytes(couplingDataCache->NodeLateralInflowSlot.Buffers[i]);
+    size += valuesBytes(couplingDataCache->NodeDepthSlot.Buffers[i]);
   }
+
+  size += vectorBytes(couplingDataCache->SurfaceExchangeWork);
+  size += vectorBytes(grid.RowStart) + vectorBytes(grid.Cells) +
+          vectorBytes(grid.Weights) + vectorBytes(grid.Rows);
+  size += samplesBytes(couplingDataCache->NodeLateralInflowSamples);
+  size += samplesBytes(couplingDataCache->NodeDepthSamples);
+  size += vectorBytes(couplingDataCache->StateAverages);
+
+  for(const CouplingStateAverage &average : couplingDataCache->StateAverages)
+    size += vectorBytes(average.Sums);
+
+  return size;
 }
 
 //node lateral inflow
 void addNodeLateralInflow(Project* project, int index, double value)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
-  couplingDataCache->NodeLateralInflows[index] += value;
+  couplingDataCache->NodeLateralInflows.add(index, value);
 }
 
-int containsNodeLateralInflow(Project* project, int index, double* const  value)
+void addNodeLateralInflows(Project* project, int count, const int* indexes, const double* values)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
-  unordered_map<int, double >::iterator it = couplingDataCache->NodeLateralInflows.find(index);
-
-  if (it != couplingDataCache->NodeLateralInflows.end())
+  for (int i = 0; i < count; i++)
   {
-    *value = (*it).second;
-    return 1;
+    couplingDataCache->NodeLateralInflows.add(indexes[i], values[i]);
   }
+}
 
-  return 0;
+int containsNodeLateralInflow(Project* project, int index, double* const  value)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  return containsValue(couplingDataCache->NodeLateralInflows, index, value);
+}
+
+int getNodeLateralInflows(Project* project, int count, const int* indexes, double* values)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  return getValues(couplingDataCache->NodeLateralInflows, count, indexes, values);
 }
 
 //node lateral inflow
 int removeNodeLateralInflow(Project* project, int index)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
-  return couplingDataCache->NodeLateralInflows.erase(index);
+  return couplingDataCache->NodeLateralInflows.remove(index);
 }
 
 //Node Depths
 void addNodeDepth(Project* project, int index, double value)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
-  couplingDataCache->NodeDepths[index] = value;
+  couplingDataCache->NodeDepths.set(index, value);
 }
 
-int containsNodeDepth(Project* project, int index, double* const value)
+void addNodeDepths(Project* project, int count, const int* indexes, const double* values)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
-  unordered_map<int, double > ::iterator it = couplingDataCache->NodeDepths.find(index);
-
-  if (it != couplingDataCache->NodeDepths.end())
+  for (int i = 0; i < count; i++)
   {
-    *value = (*it).second;
-    return 1;
+    couplingDataCache->NodeDepths.set(indexes[i], values[i]);
   }
+}
 
-  return 0;
+int containsNodeDepth(Project* project, int index, double* const value)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  return containsValue(couplingDataCache->NodeDepths, index, value);
+}
 
+int getNodeDepths(Project* project, int count, const int* indexes, double* values)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  return getValues(couplingDataCache->NodeDepths, count, indexes, values);
 }
 
 int removeNodeDepth(Project* project, int index)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
-  return couplingDataCache->NodeDepths.erase(index);
+  return couplingDataCache->NodeDepths.remove(index);
 }
 
 //SubcatchRainfall
 void addSubcatchRain(Project* project, int index, double value)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
-  couplingDataCache->SubcatchRainfall[index] = value;
+  couplingDataCache->SubcatchRainfall.set(index, value);
+}
+
+void addSubcatchRains(Project* project, int count, const int* indexes, const double* values)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  for (int i = 0; i < count; i++)
+  {
+    couplingDataCache->SubcatchRainfall.set(indexes[i], values[i]);
+  }
 }
 
 int containsSubcatchRain(Project* project, int index, double* const value)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
-  unordered_map<int, double > ::iterator it = couplingDataCache->SubcatchRainfall.find(index);
+  //called for every subcatchment on each runoff step
+  if (couplingDataCache == nullptr)
+    return 0;
+
+  return containsValue(couplingDataCache->SubcatchRainfall, index, value);
+}
+
+int getSubcatchRains(Project* project, int count, const int* indexes, double* values)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  return getValues(couplingDataCache->SubcatchRainfall, count, indexes, values);
+}
+
+int removeSubcatchRain(Project* project, int index)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  return couplingDataCache->SubcatchRainfall.remove(index);
+}
+
+//marks the subcatchments with grid weights once the matrix has been filled
+static int finishRainfallGrid(CouplingRainfallGrid &grid, int cellCount)
+{
+  int rowCount = (int)grid.RowStart.size() - 1;
+
+  grid.CellCount = cellCount;
+  grid.RowCount = 0;
+  grid.Rows.assign((rowCount + 63) / 64, 0);
 
-  if (it != couplingDataCache->SubcatchRainfall.end())
+  for (int j = 0; j < rowCount; j++)
   {
-    *value = (*it).second;
-    return 1;
+    if (grid.RowStart[j + 1] > grid.RowStart[j])
+    {
+      grid.Rows[j >> 6] |= (uint64_t)1 << (j & 63);
+      grid.RowCount++;
+    }
   }
 
-  return 0;
+  return grid.RowCount;
 }
 
-int removeSubcatchRain(Project* project, int index)
+int setRainfallGridWeights(Project* project, int cellCount, const int* rowStart,
+                           const int* cells, const double* weights)
 {
-  int removed = 0;
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if (couplingDataCache == nullptr)
+    return -1;
+
+  CouplingRainfallGrid &grid = couplingDataCache->RainfallGrid;
+  int n = project->Nobjects[SUBCATCH];
+
+  grid.clear();
+
+  if (cellCount < 0 || rowStart[0] != 0)
+    return -1;
+
+  for (int j = 0; j < n; j++)
+  {
+    if (rowStart[j + 1] < rowStart[j])
+      return -1;
+  }
 
+  for (int k = 0; k < rowStart[n]; k++)
+  {
+    if (cells[k] < 0 || cells[k] >= cellCount)
+      return -1;
+  }
+
+  grid.RowStart.assign(rowStart, rowStart + n + 1);
+  grid.Cells.assign(cells, cells + rowStart[n]);
+  grid.Weights.assign(weights, weights + rowStart[n]);
+
+  return finishRainfallGrid(grid, cellCount);
+}
+
+int setRainfallGridOverlaps(Project* project, int cellCount, int count, const int* subcatchs,
+                            const int* cells, const double* areas)
+{
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
-  removed = couplingDataCache->SubcatchRainfall.erase(index);
 
-  return removed;
+  if (couplingDataCache == nullptr)
+    return -1;
+
+  CouplingRainfallGrid &grid = couplingDataCache->RainfallGrid;
+  int n = project->Nobjects[SUBCATCH];
+
+  grid.clear();
+
+  for (int i = 0; i < count; i++)
+  {
+    if (subcatchs[i] < 0 || subcatchs[i] >= n || cells[i] < 0 || cells[i] >= cellCount)
+      return -1;
+  }
+
+  //count overlaps per subcatchment, then place them row by row keeping their input order
+  std::vector<double> totalArea(n, 0.0);
+  grid.RowStart.assign(n + 1, 0);
+
+  for (int i = 0; i < count; i++)
+  {
+    if (areas[i] > 0.0)
+    {
+      grid.RowStart[subcatchs[i] + 1]++;
+      totalArea[subcatchs[i]] += areas[i];
+    }
+  }
+
+  for (int j = 0; j < n; j++)
+  {
+    grid.RowStart[j + 1] += grid.RowStart[j];
+  }
+
+  std::vector<int> next(grid.RowStart.begin(), grid.RowStart.end() - 1);
+  grid.Cells.resize(grid.RowStart[n]);
+  grid.Weights.resize(grid.RowStart[n]);
+
+  for (int i = 0; i < count; i++)
+  {
+    if (areas[i] > 0.0)
+    {
+      int k = next[subcatchs[i]]++;
+      grid.Cells[k] = cells[i];
+      grid.Weights[k] = areas[i] / totalArea[subcatchs[i]];
+    }
+  }
+
+  return finishRainfallGrid(grid, cellCount);
 }
 
-void clearDataCache(Project *project)
+int applyRainfallGrid(Project* project, const double* cellRainfall)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if (couplingDataCache == nullptr)
+    return 0;
+
+  CouplingRainfallGrid &grid = couplingDataCache->RainfallGrid;
+  CouplingValues &rainfall = couplingDataCache->SubcatchRainfall;
+  int n = (int)grid.RowStart.size() - 1;
+
+  if (grid.RowCount == 0 || n != rainfall.size())
+    return 0;
+
+  const int* rowStart = grid.RowStart.data();
+  const int* cells = grid.Cells.data();
+  const double* weights = grid.Weights.data();
+  double* values = rainfall.Values.data();
+
+  //each row writes only its own subcatchment's value
+#pragma omp parallel for schedule(static) if(grid.Cells.size() > 10000)
+  for (int j = 0; j < n; j++)
+  {
+    if (rowStart[j + 1] == rowStart[j])
+      continue;
+
+    double sum = 0.0;
+
+    for (int k = rowStart[j]; k < rowStart[j + 1]; k++)
+    {
+      sum += weights[k] * cellRainfall[cells[k]];
+    }
+
+    values[j] = sum;
+  }
+
+  for (size_t w = 0; w < grid.Rows.size(); w++)
+  {
+    rainfall.Present[w] |= grid.Rows[w];
+  }
+
+  return grid.RowCount;
+}
+
+int getStateView(Project* project, int type, CouplingStateView* view)
+{
+  view->data = nullptr;
+  view->stride = 0;
+  view->count = 0;
+
+  switch (type)
+  {
+    case COUPLING_NODE_DEPTH:
+    case COUPLING_NODE_INFLOW:
+    case COUPLING_NODE_OVERFLOW:
+      {
+        view->count = project->Nobjects[NODE];
+        view->stride = sizeof(TNode);
+
+        if (view->count > 0)
+        {
+          TNode* node = &project->Node[0];
+          view->data = type == COUPLING_NODE_DEPTH ? &node->newDepth :
+                       type == COUPLING_NODE_INFLOW ? &node->inflow : &node->overflowAndInflow;
+        }
+      }
+      break;
+    case COUPLING_LINK_FLOW:
+    case COUPLING_LINK_DEPTH:
+      {
+        view->count = project->Nobjects[LINK];
+        view->stride = sizeof(TLink);
+
+        if (view->count > 0)
+        {
+          TLink* link = &project->Link[0];
+          view->data = type == COUPLING_LINK_FLOW ? &link->newFlow : &link->newDepth;
+        }
+      }
+      break;
+    case COUPLING_SUBCATCH_RUNOFF:
+      {
+        view->count = project->Nobjects[SUBCATCH];
+        view->stride = sizeof(TSubcatch);
+
+        if (view->count > 0)
+        {
+          view->data = &project->Subcatch[0].newRunoff;
+        }
+      }
+      break;
+    default:
+      //heads are not stored and must be copied out
+      return 0;
+  }
+
+  return 1;
+}
+
+int copyStateValues(Project* project, int type, int start, int count, double* values)
+{
+  CouplingStateView view;
+
+  if (start < 0)
+    return 0;
+
+  if (type == COUPLING_NODE_HEAD)
+  {
+    count = std::max(0, std::min(count, project->Nobjects[NODE] - start));
+
+    for (int i = 0; i < count; i++)
+    {
+      TNode* node = &project->Node[start + i];
+      values[i] = node->newDepth + node->invertElev;
+    }
+
+    return count;
+  }
+
+  if (!getStateView(project, type, &view))
+    return 0;
+
+  count = std::max(0, std::min(count, view.count - start));
+  const char* data = (const char*)view.data + (size_t)start * view.stride;
+
+  for (int i = 0; i < count; i++)
+  {
+    values[i] = *(const double*)(data + (size_t)i * view.stride);
+  }
+
+  return count;
+}
+
+void addNodeLateralInflowSample(Project* project, int index, double time, double value)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  couplingDataCache->NodeLateralInflowSamples.add(index, time, value);
+}
+
+void addNodeLateralInflowSamples(Project* project, double time, int count, const int* indexes, const double* values)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  for (int i = 0; i < count; i++)
+  {
+    couplingDataCache->NodeLateralInflowSamples.add(indexes[i], time, values[i]);
+  }
+}
+
+void addNodeDepthSample(Project* project, int index, double time, double value)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  couplingDataCache->NodeDepthSamples.add(index, time, value);
+}
+
+void addNodeDepthSamples(Project* project, double time, int count, const int* indexes, const double* values)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  for (int i = 0; i < count; i++)
+  {
+    couplingDataCache->NodeDepthSamples.add(indexes[i], time, values[i]);
+  }
+}
+
+void clearCouplingSamples(Project* project)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
   if(couplingDataCache)
   {
-    int max = project->Nobjects[NODE];
+    couplingDataCache->NodeLateralInflowSamples.clear();
+    couplingDataCache->NodeDepthSamples.clear();
+  }
+}
+
+static CouplingStateAverage* getStateAverage(Project* project, int type)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if (couplingDataCache == nullptr || type < 0 || type >= (int)couplingDataCache->StateAverages.size())
+    return nullptr;
+
+  return &couplingDataCache->StateAverages[type];
+}
+
+int startStateAveraging(Project* project, int type)
+{
+  CouplingStateAverage* average = getStateAverage(project, type);
+
+  if (average == nullptr)
+    return 0;
+
+  int count = type == COUPLING_NODE_HEAD ? project->Nobjects[NODE] :
+              type == COUPLING_LINK_FLOW || type == COUPLING_LINK_DEPTH ? project->Nobjects[LINK] :
+              type == COUPLING_SUBCATCH_RUNOFF ? project->Nobjects[SUBCATCH] : project->Nobjects[NODE];
+
+  average->Active = true;
+  average->Duration = 0.0;
+  average->Sums.assign(count, 0.0);
+  return 1;
+}
+
+int getAveragedStateValues(Project* project, int type, int start, int count, double* values, double* duration)
+{
+  CouplingStateAverage* average = getStateAverage(project, type);
+
+  if (duration) *duration = 0.0;
+
+  if (start < 0)
+    return 0;
+
+  if (average == nullptr || average->Duration <= 0.0)
+    return copyStateValues(project, type, start, count, values);
+
+  count = std::max(0, std::min(count, (int)average->Sums.size() - start));
+
+  for (int i = 0; i < count; i++)
+  {
+    values[i] = average->Sums[start + i] / average->Duration;
+  }
+
+  if (duration) *duration = average->Duration;
+  return count;
+}
+
+void stopStateAveraging(Project* project, int type)
+{
+  CouplingStateAverage* average = getStateAverage(project, type);
+
+  if (average)
+  {
+    average->Active = false;
+  }
+}
+
+static int getStateVectorPartSize(Project* project, int part)
+{
+  switch (part)
+  {
+    case STATE_VECTOR_NODE_DEPTH:
+    case STATE_VECTOR_NODE_VOLUME:
+      return project->Nobjects[NODE];
+    case STATE_VECTOR_LINK_FLOW:
+    case STATE_VECTOR_LINK_DEPTH:
+      return project->Nobjects[LINK];
+    case STATE_VECTOR_GW_LEVEL:
+      return project->Nobjects[SUBCATCH];
+  }
+
+  return 0;
+}
+
+int getStateVectorSize(Project* project, int parts)
+{
+  int size = 0;
+
+  for (int part = STATE_VECTOR_NODE_DEPTH; part <= STATE_VECTOR_GW_LEVEL; part <<= 1)
+  {
+    if (parts & part)
+      size += getStateVectorPartSize(project, part);
+  }
+
+  return size;
+}
+
+int getStateVectorOffset(Project* project, int parts, int part)
+{
+  if (!(parts & part) || getStateVectorPartSize(project, part) == 0)
+    return -1;
+
+  return getStateVectorSize(project, parts & (part - 1));
+}
+
+int gatherStateVector(Project* project, int parts, double* x)
+{
+  int nNodes = project->Nobjects[NODE];
+  int nLinks = project->Nobjects[LINK];
+  int nSubcatch = project->Nobjects[SUBCATCH];
+
+  if (parts & STATE_VECTOR_NODE_DEPTH)
+  {
+    for (int j = 0; j < nNodes; j++)
+      x[j] = project->Node[j].newDepth;
+
+    x += nNodes;
+  }
+
+  if (parts & STATE_VECTOR_NODE_VOLUME)
+  {
+    for (int j = 0; j < nNodes; j++)
+      x[j] = project->Node[j].newVolume;
+
+    x += nNodes;
+  }
+
+  if (parts & STATE_VECTOR_LINK_FLOW)
+  {
+    for (int j = 0; j < nLinks; j++)
+      x[j] = project->Link[j].newFlow;
 
-    for (int j = 0; j < max; j++)
+    x += nLinks;
+  }
+
+  if (parts & STATE_VECTOR_LINK_DEPTH)
+  {
+    for (int j = 0; j < nLinks; j++)
+      x[j] = project->Link[j].newDepth;
+
+    x += nLinks;
+  }
+
+  if (parts & STATE_VECTOR_GW_LEVEL)
+  {
+    for (int j = 0; j < nSubcatch; j++)
     {
-      couplingDataCache->NodeLateralInflows[j] = 0.0;
+      TGroundwater* gw = project->Subcatch[j].groundwater;
+      x[j] = gw ? gw->bottomElev + gw->lowerDepth : 0.0;
     }
+  }
 
-    couplingDataCache->NodeDepths.clear();
-    couplingDataCache->SubcatchRainfall.clear();
-    couplingDataCache->XSections.clear();
+  return getStateVectorSize(project, parts);
+}
+
+int scatterStateVector(Project* project, int parts, const double* x)
+{
+  int nNodes = project->Nobjects[NODE];
+  int nLinks = project->Nobjects[LINK];
+  int nSubcatch = project->Nobjects[SUBCATCH];
+  const double* depths = nullptr;
+  const double* volumes = nullptr;
+
+  if (parts & STATE_VECTOR_NODE_DEPTH)
+  {
+    depths = x;
+    x += nNodes;
+  }
+
+  if (parts & STATE_VECTOR_NODE_VOLUME)
+  {
+    volumes = x;
+    x += nNodes;
+  }
+
+  //depth-volume relations are evaluated in one pass over the nodes
+  if (depths || volumes)
+  {
+#pragma omp parallel for schedule(static) if(nNodes > 10000)
+    for (int j = 0; j < nNodes; j++)
+    {
+      TNode* node = &project->Node[j];
+      bool ponded = project->AllowPonding && node->pondedArea > 0.0;
+
+      if (depths)
+      {
+        node->newDepth = std::max(depths[j], 0.0);
+
+        if (ponded && node->newDepth > node->fullDepth)
+          node->newVolume = node->fullVolume + (node->newDepth - node->fullDepth) * node->pondedArea;
+        else
+          node->newVolume = node_getVolume(project, j, node->newDepth);
+      }
+      else if (node->type == STORAGE)
+      {
+        node->newVolume = std::max(volumes[j], 0.0);
+
+        if (ponded && node->newVolume > node->fullVolume)
+          node->newDepth = node->fullDepth + (node->newVolume - node->fullVolume) / node->pondedArea;
+        else
+          node->newDepth = node_getDepth(project, j, node->newVolume);
+      }
+    }
+  }
+
+  if (parts & STATE_VECTOR_LINK_FLOW)
+  {
+    for (int j = 0; j < nLinks; j++)
+    {
+      TLink* link = &project->Link[j];
+      link->newFlow = x[j];
+
+      if (link->type == CONDUIT)
+      {
+        TConduit* conduit = &project->Conduit[link->subIndex];
+        conduit->q1 = link->newFlow / conduit->barrels;
+        conduit->q2 = conduit->q1;
+      }
+    }
+
+    x += nLinks;
+  }
+
+  if (parts & STATE_VECTOR_LINK_DEPTH)
+  {
+#pragma omp parallel for schedule(static) if(nLinks > 10000)
+    for (int j = 0; j < nLinks; j++)
+    {
+      TLink* link = &project->Link[j];
+      link->newDepth = std::max(x[j], 0.0);
+
+      if (link->type == CONDUIT)
+      {
+        TConduit* conduit = &project->Conduit[link->subIndex];
+        conduit->a1 = xsect_getAofY(project, &link->xsect, link->newDepth);
+        conduit->a2 = conduit->a1;
+        link->newVolume = conduit->a1 * link_getLength(project, j) * conduit->barrels;
+      }
+    }
+
+    x += nLinks;
+  }
+
+  if (parts & STATE_VECTOR_GW_LEVEL)
+  {
+    for (int j = 0; j < nSubcatch; j++)
+    {
+      TGroundwater* gw = project->Subcatch[j].groundwater;
+
+      if (gw)
+      {
+        gw->lowerDepth = std::max(0.0, std::min(x[j], gw->surfElev) - gw->bottomElev);
+      }
+    }
   }
+
+  return getStateVectorSize(project, parts);
 }
 
-void disposeCoupledDataCache(Project *project)
+int gatherEnsembleStateVectors(Project** members, int count, int parts, double* x)
+{
+  if (count <= 0)
+    return 0;
+
+  int size = getStateVectorSize(members[0], parts);
+
+#pragma omp parallel for schedule(static)
+  for (int m = 0; m < count; m++)
+  {
+    gatherStateVector(members[m], parts, x + (size_t)m * size);
+  }
+
+  return size;
+}
+
+int scatterEnsembleStateVectors(Project** members, int count, int parts, const double* x)
+{
+  if (count <= 0)
+    return 0;
+
+  int size = getStateVectorSize(members[0], parts);
+
+#pragma omp parallel for schedule(static)
+  for (int m = 0; m < count; m++)
+  {
+    scatterStateVector(members[m], parts, x + (size_t)m * size);
+  }
+
+  return size;
+}
+
+int beginExchange(Project* project, int type)
+{
+  CouplingExchangeSlot* slot = getExchangeSlot(project, type);
+  return slot && slot->beginWrite() ? 1 : 0;
+}
+
+void setExchangeValues(Project* project, int type, int count, const int* indexes, const double* values)
+{
+  CouplingExchangeSlot* slot = getExchangeSlot(project, type);
+
+  CouplingValues* buffer = slot ? slot->writeBuffer() : nullptr;
+
+  if (buffer)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      buffer->set(indexes[i], values[i]);
+    }
+  }
+}
+
+unsigned int publishExchange(Project* project, int type)
+{
+  CouplingExchangeSlot* slot = getExchangeSlot(project, type);
+  return slot ? slot->publish() : 0;
+}
+
+unsigned int getExchangeEpoch(Project* project, int type, unsigned int* consumed)
+{
+  CouplingExchangeSlot* slot = getExchangeSlot(project, type);
+
+  if (slot == nullptr)
+  {
+    if (consumed) *consumed = 0;
+    return 0;
+  }
+
+  if (consumed) *consumed = slot->Consumed.load(std::memory_order_acquire);
+  return slot->Published.load(std::memory_order_acquire);
+}
+
+int computeSurfaceExchange(Project* project, int count, const int* nodes,
+                           const double* surfaceElevs, double* flows)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if (couplingDataCache == nullptr || count <= 0)
+    return 0;
+
+  //gather node properties into contiguous arrays so the exchange loop below vectorizes
+  std::vector<double> &work = couplingDataCache->SurfaceExchangeWork;
+  work.resize(6 * (size_t)count);
+
+  double *rimElev = &work[0];
+  double *head = rimElev + count;
+  double *area = head + count;
+  double *perimeter = area + count;
+  double *coeff = perimeter + count;
+  double *q = coeff + count;
+  int n = 0;
+
+  for (int i = 0; i < count; i++)
+  {
+    if (nodes[i] < 0 || nodes[i] >= project->Nobjects[NODE])
+      continue;
+
+    TNode *node = &project->Node[nodes[i]];
+    rimElev[n] = node->invertElev + node->fullDepth;
+    head[n] = node->invertElev + node->newDepth;
+    area[n] = node->area;
+    perimeter[n] = node->perimeter;
+    coeff[n] = node->orificeDischargeCoeff;
+    q[n] = surfaceElevs[i];
+    n++;
+  }
+
+  const double sqrt2g = sqrt(2.0 * GRAVITY);
+
+#pragma omp simd
+  for (int k = 0; k < n; k++)
+  {
+    double surfaceHead = std::max(q[k], rimElev[k]);
+    double h = surfaceHead - rimElev[k];
+    double dh = surfaceHead - head[k];
+    double weirFlow = (2.0 / 3.0) * coeff[k] * perimeter[k] * sqrt2g * h * sqrt(h);
+    double orificeFlow = coeff[k] * area[k] * sqrt2g * sqrt(h);
+    double freeFlow = std::min(weirFlow, orificeFlow);
+    double submergedFlow = copysign(coeff[k] * area[k] * sqrt2g * sqrt(fabs(dh)), dh);
+
+    q[k] = head[k] > rimElev[k] ? submergedFlow : freeFlow;
+  }
+
+  //scatter into the lateral inflow cache in the caller's order
+  for (int i = 0, k = 0; i < count; i++)
+  {
+    if (nodes[i] < 0 || nodes[i] >= project->Nobjects[NODE])
+    {
+      if (flows) flows[i] = 0.0;
+      continue;
+    }
+
+    couplingDataCache->NodeLateralInflows.add(nodes[i], q[k]);
+    if (flows) flows[i] = q[k];
+    k++;
+  }
+
+  return n;
+}
+
+void clearDataCache(Project *project)
 {
   CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
@@ -169,6 +950,15 @@ void disposeCoupledDataCache(Project *project)
     couplingDataCache->NodeDepths.clear();
     couplingDataCache->SubcatchRainfall.clear();
     couplingDataCache->XSections.clear();
+  }
+}
+
+void disposeCoupledDataCache(Project *project)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if(couplingDataCache)
+  {
     delete couplingDataCache;
     project->couplingDataCache = nullptr;
   }
@@ -182,33 +972,43 @@ void applyCouplingNodeDepths(Project* project)
 {
   int j;
   int max = project->Nobjects[NODE];
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
   for (j = 0; j < max; j++)
   {
-    double value = 0;
-    TNode *node = &project->Node[j];
-    node->depthSetExternally = 0;
+    project->Node[j].depthSetExternally = 0;
+  }
 
-    if (containsNodeDepth(project, j, &value))
-    {
+  if(couplingDataCache == nullptr)
+    return;
+
+  couplingDataCache->NodeDepthSlot.receive(couplingDataCache->NodeDepths);
+  couplingDataCache->NodeDepthSamples.interpolate(project->NewRoutingTime / MSECperDAY);
 
-      node->oldDepth = value;
-      node->newDepth = value;
-      node->depthSetExternally = 1;
+  auto setDepth = [project](int j, double value)
+  {
+    TNode *node = &project->Node[j];
 
-      if(value > node->fullDepth && node->pondedArea > 0)
+    node->oldDepth = value;
+    node->newDepth = value;
+    node->depthSetExternally = 1;
+
+    if(value > node->fullDepth && node->pondedArea > 0)
+    {
+      if(value <= node->fullDepth)
       {
-        if(value <= node->fullDepth)
-        {
-          node->oldVolume = node_getVolume(project, j, value);
-        }
-        else
-        {
-          node->oldVolume = node->fullVolume + (node->oldDepth - node->fullDepth) * node->pondedArea;
-        }
+        node->oldVolume = node_getVolume(project, j, value);
+      }
+      else
+      {
+        node->oldVolume = node->fullVolume + (node->oldDepth - node->fullDepth) * node->pondedArea;
       }
     }
-  }
+  };
+
+  //interpolated samples are applied last so they take the place of cached depths
+  couplingDataCache->NodeDepths.forEach(setDepth);
+  couplingDataCache->NodeDepthSamples.Current.forEach(setDepth);
 }
 
 /*!
@@ -217,20 +1017,110 @@ void applyCouplingNodeDepths(Project* project)
  */
 void applyCouplingLateralInflows(Project* project)
 {
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
 
-  int j;
-  int max = project->Nobjects[NODE];
+  if(couplingDataCache == nullptr)
+    return;
+
+  couplingDataCache->NodeLateralInflowSlot.receive(couplingDataCache->NodeLateralInflows);
+
+  couplingDataCache->NodeLateralInflows.forEach([project](int j, double value)
+  {
+    TNode* node = &project->Node[j];
+    node->newLatFlow += value;
+    massbal_addInflowFlow(project, EXTERNAL_INFLOW, value);
+  });
+
+  couplingDataCache->NodeLateralInflowSamples.interpolate(project->NewRoutingTime / MSECperDAY);
 
-  for(j = 0; j < max; j++)
+  couplingDataCache->NodeLateralInflowSamples.Current.forEach([project](int j, double value)
   {
-    double value = 0;
+    TNode* node = &project->Node[j];
+    node->newLatFlow += value;
+    massbal_addInflowFlow(project, EXTERNAL_INFLOW, value);
+  });
+}
+
+/*!
+ * \brief isCouplingRaining
+ * \param project
+ * \return 1 if any subcatchment has a positive coupled rainfall
+ */
+int isCouplingRaining(Project* project)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+  int raining = 0;
 
-    if(containsNodeLateralInflow(project, j, &value))
+  if(couplingDataCache)
+  {
+    couplingDataCache->SubcatchRainfall.forEach([&raining](int, double value)
     {
-      TNode* node = &project->Node[j];
-      node->newLatFlow += value;
-      massbal_addInflowFlow(project, EXTERNAL_INFLOW, value);
+      if(value > 0.0)
+        raining = 1;
+    });
+  }
+
+  return raining;
+}
+
+/*!
+ * \brief accumulateCouplingStates adds each averaged state over a routing step
+ * \param project
+ * \param tStep routing time step (sec)
+ */
+void accumulateCouplingStates(Project* project, double tStep)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if(couplingDataCache == nullptr)
+    return;
+
+  for(size_t type = 0; type < couplingDataCache->StateAverages.size(); type++)
+  {
+    CouplingStateAverage &average = couplingDataCache->StateAverages[type];
+    CouplingStateView view;
+
+    if(!average.Active)
+      continue;
+
+    int count = (int)average.Sums.size();
+    double* sums = average.Sums.data();
+
+    if(type == COUPLING_NODE_HEAD)
+    {
+      for(int i = 0; i < count; i++)
+      {
+        sums[i] += (project->Node[i].newDepth + project->Node[i].invertElev) * tStep;
+      }
     }
+    else if(getStateView(project, (int)type, &view))
+    {
+      const char* data = (const char*)view.data;
+
+      for(int i = 0; i < count; i++)
+      {
+        sums[i] += *(const double*)(data + (size_t)i * view.stride) * tStep;
+      }
+    }
+
+    average.Duration += tStep;
   }
 }
 
+/*!
+ * \brief resetCouplingStateAverages restarts each active state average from zero
+ * \param project
+ */
+void resetCouplingStateAverages(Project* project)
+{
+  CouplingDataCache* couplingDataCache  = (CouplingDataCache*)project->couplingDataCache;
+
+  if(couplingDataCache == nullptr)
+    return;
+
+  for(CouplingStateAverage &average : couplingDataCache->StateAverages)
+  {
+    average.Duration = 0.0;
+    std::fill(average.Sums.begin(), average.Sums.end(), 0.0);
+  }
+}
@@ -0,0 +1,85 @@
+/*!
+ * \file swmmbenchmarkclass.h
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+#ifdef SWMM_TEST
+
+#include <QtTest/QtTest>
+
+typedef struct Project Project;
+
+/*!
+ * \brief The SWMMBenchmarkClass class times the engine's inner kernels in isolation so
+ * that regressions in any one of them show up. Each benchmark times a fixed batch of
+ * calls. Run the test executable with -csv, -xml or "-o file,xml" for machine-readable
+ * results.
+ */
+class SWMMBenchmarkClass : public QObject
+{
+
+    Q_OBJECT
+
+  private slots:
+
+    void initTestCase();
+
+    void xsectGetAofY_data();
+
+    void xsectGetAofY();
+
+    void xsectGetYofA_data();
+
+    void xsectGetYofA();
+
+    void xsectGetRofA_data();
+
+    void xsectGetRofA();
+
+    void tableLookup_data();
+
+    void tableLookup();
+
+    void tableTseriesLookup_data();
+
+    void tableTseriesLookup();
+
+    void mathexprEval();
+
+    void dwflowFindConduitFlow();
+
+    void setNodeDepth();
+
+    void infiltration_data();
+
+    void infiltration();
+
+    void rdiiUnitHydConvol();
+
+    void cleanupTestCase();
+
+  private:
+
+    static QString writeModel(const QString &name, const QString &infilModel, int nodes, int days);
+
+    Project *m_project = nullptr;
+    QString m_modelFile;
+    double m_sink = 0.0;
+};
+
+#endif
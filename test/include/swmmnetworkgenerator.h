@@ -0,0 +1,73 @@
+/*!
+ * \file swmmnetworkgenerator.h
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+#ifndef SWMMNETWORKGENERATOR_H
+#define SWMMNETWORKGENERATOR_H
+
+#ifdef SWMM_TEST
+
+#include <string>
+
+enum SWMMNetworkTopology
+{
+  DENDRITIC_NETWORK,
+  LOOPED_NETWORK
+};
+
+/*!
+ * \brief The SWMMNetworkOptions struct describes a synthetic sewer network. The network
+ * is made of independent sewersheds of SewershedSize nodes, each a random tree draining
+ * to its own outfall, so pipe sizes stay realistic however many nodes are generated.
+ * Every junction receives runoff from one subcatchment and, optionally, dry weather flow.
+ */
+struct SWMMNetworkOptions
+{
+    int Nodes = 10000;
+    int SewershedSize = 500;
+    SWMMNetworkTopology Topology = DENDRITIC_NETWORK;
+    double LoopFraction = 0.05;     //looped networks: cross connections per junction
+    double StorageFraction = 0.01;  //junctions replaced by storage units
+    double PumpFraction = 0.5;      //storage units drained by a pump rather than a conduit
+    double WeirFraction = 0.01;     //junctions with an overflow weir to the outfall
+    bool Rainfall = true;
+    bool DryWeatherFlow = true;
+    int RainGages = 0;              //0 selects one gage per 10 sewersheds
+    int Hours = 6;                  //simulation duration
+    double RoutingStep = 5.0;       //seconds
+    int Threads = 0;                //THREADS option; 0 uses all available
+    unsigned int Seed = 1;
+};
+
+/*!
+ * \brief writeSWMMNetwork writes the network described by options to the SWMM input
+ * file fileName. The same options and seed always produce the same file.
+ * \return False if the file could not be written.
+ */
+bool writeSWMMNetwork(const SWMMNetworkOptions &options, const std::string &fileName);
+
+/*!
+ * \brief parseSWMMNetworkTopology converts "dendritic" or "looped" to a topology.
+ * \return False if name is not a topology.
+ */
+bool parseSWMMNetworkTopology(const std::string &name, SWMMNetworkTopology *topology);
+
+#endif
+
+#endif // SWMMNETWORKGENERATOR_H
@@ -0,0 +1,41 @@
+/*!
+ * \file swmmprocessmemory.h
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+#ifndef SWMMPROCESSMEMORY_H
+#define SWMMPROCESSMEMORY_H
+
+#ifdef SWMM_TEST
+
+/*!
+ * \brief resetPeakMemory restarts the peak resident set size count. Linux keeps the
+ * peak in VmHWM, which can be reset between runs. Elsewhere the peak can only grow,
+ * so runs should go from small to large models.
+ */
+void resetPeakMemory();
+
+/*!
+ * \brief peakMemory returns the peak resident set size of the process (MB), or 0 if
+ * it is not available.
+ */
+double peakMemory();
+
+#endif
+
+#endif // SWMMPROCESSMEMORY_H
@@ -0,0 +1,123 @@
+/*!
+ * \file swmmregressionclass.h
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+#ifdef SWMM_TEST
+
+#include <QtTest/QtTest>
+
+/*!
+ * \brief The SWMMRegressionClass class runs every example input file and a synthetic
+ * network under each flow routing model and thread count. For each run it records the
+ * wall time, routing steps, flow routing iterations, non-converging steps, flow
+ * continuity error, peak resident memory and project memory, and for the examples the
+ * worst mean absolute error of the reported link flows and node depths against the
+ * example's _q.dat and _y.dat reference series, as a fraction of each series' peak.
+ * Results are written to a CSV file and compared with a baseline file of the same
+ * format; a run fails when it is slower, iterates more, is less accurate or uses more
+ * memory than its baseline run by more than the tolerance.
+ *
+ * The environment variables SWMM_REGRESSION_EXAMPLES (./../../examples),
+ * SWMM_REGRESSION_ROUTING (DYNWAVE,KINWAVE,STEADY), SWMM_REGRESSION_THREADS (1 and the
+ * number of processors) and SWMM_REGRESSION_NODES (1000, 0 for none) choose the runs,
+ * SWMM_REGRESSION_CSV the results file (swmm_regression.csv in the temp directory) and
+ * SWMM_REGRESSION_BASELINE the baseline file (swmm_regression_baseline.csv in the
+ * examples directory). The test fails when the
+ * baseline is missing; with SWMM_REGRESSION_UPDATE set it is written from the results
+ * instead of compared with them. The committed baseline was recorded at 1 thread on a
+ * single core machine, so its times only suit machines of about that speed.
+ *
+ * SWMM_REGRESSION_TIME_TOLERANCE (0.25), SWMM_REGRESSION_COUNT_TOLERANCE (0.05) and
+ * SWMM_REGRESSION_MEMORY_TOLERANCE (0.25) are allowed relative increases of time, steps
+ * and iterations, and project memory; SWMM_REGRESSION_ERROR_TOLERANCE (0.005) and
+ * SWMM_REGRESSION_CONTINUITY_TOLERANCE (0.5 percent) allowed absolute increases of the
+ * reference and continuity errors. A dynamic wave run also fails when its reference
+ * error exceeds SWMM_REGRESSION_MAX_ERROR (0.15, 0 for no limit), or for the examples
+ * whose legacy EXTRAN series it has never matched closely a limit of their own (extran3,
+ * user2, user3 and user5 0.25, extran8a 1.0, extran6 5.0). SWMM_REGRESSION_MODEL_MAX_ERRORS
+ * sets such limits as a list of model=limit pairs.
+ *
+ * A run at 1 thread is always made, before any with more threads, and a run with more
+ * threads fails unless its steps, iterations, non-converging steps, continuity error and
+ * reference error are exactly those of the 1 thread run of the same model and routing.
+ * The baseline therefore only needs 1 thread rows.
+ */
+class SWMMRegressionClass : public QObject
+{
+
+    Q_OBJECT
+
+  private slots:
+
+    void initTestCase();
+
+    void regression_data();
+
+    void regression();
+
+    void cleanupTestCase();
+
+  private:
+
+    struct ReferenceSeries
+    {
+        QString Id;
+        QVector<double> Times;  //seconds from the start of the simulation
+        QVector<double> Values;
+    };
+
+    struct RegressionResult
+    {
+        double Seconds = 0.0;
+        long Steps = 0;
+        long Iterations = 0;
+        long NonConverging = 0;
+        double ContinuityError = 0.0;   //percent
+        double ReferenceError = -1.0;   //negative without reference series
+        double PeakMemory = 0.0;        //MB
+        double ProjectMemory = 0.0;     //MB
+    };
+
+    QString workingFile(const QString &model, const QString &routing);
+
+    static QList<ReferenceSeries> readReferenceSeries(const QString &fileName);
+
+    static QString resultRow(const QString &key, const RegressionResult &result);
+
+    static bool parseResultRow(const QString &line, QString *key, RegressionResult *result);
+
+    QString m_examplesDir;
+    QString m_workingDir;
+    QString m_csvFile;
+    QString m_baselineFile;
+    bool m_updateBaseline = false;
+    double m_timeTolerance = 0.25;
+    double m_countTolerance = 0.05;
+    double m_memoryTolerance = 0.25;
+    double m_errorTolerance = 0.005;
+    double m_continuityTolerance = 0.5;
+    double m_maxError = 0.15;       //0 for no absolute limit
+    QHash<QString, double> m_modelMaxErrors; //upper case model name to its own limit
+    QStringList m_networks;         //synthetic network input files
+    QHash<QString, RegressionResult> m_baseline;
+    QList<QPair<QString, RegressionResult>> m_results;
+    QHash<QString, QString> m_workingFiles; //model/routing to rewritten input file
+};
+
+#endif
@@ -0,0 +1,64 @@
+/*!
+ * \file swmmscalingbenchmarkclass.h
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+#ifdef SWMM_TEST
+
+#include <QtTest/QtTest>
+
+/*!
+ * \brief The SWMMScalingBenchmarkClass class runs synthetic networks written by
+ * writeSWMMNetwork at increasing sizes and thread counts. For each run it records the
+ * wall time per simulated hour of input parsing, startup, each PERF_STATS phase and
+ * shutdown, the parallel efficiency of each against the single thread run, and the
+ * peak resident memory. Results are appended to a CSV file.
+ *
+ * The environment variables SWMM_SCALING_NODES and SWMM_SCALING_THREADS take comma
+ * separated lists of network sizes (1000,10000) and thread counts (powers of two up
+ * to the number of processors), SWMM_SCALING_HOURS the simulated duration (1) and
+ * SWMM_SCALING_CSV the results file (swmm_scaling.csv in the temp directory). Networks
+ * of 100000 nodes and more take minutes per simulated hour on one thread, so they
+ * are only run when asked for.
+ */
+class SWMMScalingBenchmarkClass : public QObject
+{
+
+    Q_OBJECT
+
+  private slots:
+
+    void initTestCase();
+
+    void scaling_data();
+
+    void scaling();
+
+    void cleanupTestCase();
+
+  private:
+
+    QString modelFile(int topology, int nodes);
+
+    QString m_csvFile;
+    int m_hours = 1;
+    QSet<QString> m_models;
+    QHash<QString, double> m_serialTimes; //seconds per simulated hour of one thread runs
+};
+
+#endif
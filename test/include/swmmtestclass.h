@@ -22,6 +22,8 @@
 
 #include <QtTest/QtTest>
 
+#include "swmm5.h"
+
 class SWMMTestClass : public QObject
 {
 
@@ -35,8 +37,26 @@ class SWMMTestClass : public QObject
 
     void concurrentDifferentInputs();
 
+    void restoreState_data();
+
+    void restoreState();
+
+    void forksMatch();
+
+    void forksOnThreads();
+
+    void forksClosedBeforeParent();
+
+    void exchangeWhileStepping();
+
     void cleanup();
 
+  private:
+
+    static Project *startExample(const QString &name);
+
+    static QVector<double> stepResults(Project *project, int steps);
+
 };
 
 #endif
@@ -0,0 +1,472 @@
+/*!
+ * \file swmmbenchmarkclass.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+#ifdef SWMM_TEST
+
+#include <cstring>
+#include <omp.h>
+
+#include "swmm5.h"
+#include "headers.h"
+#include "swmmbenchmarkclass.h"
+
+//number of kernel calls timed by each benchmark iteration
+static const int BatchSize = 10000;
+
+struct BenchmarkShape
+{
+    int Type;
+    const char *Name;
+    double Params[4];
+};
+
+static const BenchmarkShape BenchmarkShapes[] =
+{
+  {CIRCULAR, "circular", {3.0, 0.0, 0.0, 0.0}},
+  {FILLED_CIRCULAR, "filled_circular", {3.0, 0.5, 0.0, 0.0}},
+  {RECT_CLOSED, "rect_closed", {3.0, 4.0, 0.0, 0.0}},
+  {RECT_OPEN, "rect_open", {3.0, 4.0, 0.0, 0.0}},
+  {TRAPEZOIDAL, "trapezoidal", {3.0, 4.0, 1.0, 1.0}},
+  {TRIANGULAR, "triangular", {3.0, 4.0, 0.0, 0.0}},
+  {PARABOLIC, "parabolic", {3.0, 4.0, 0.0, 0.0}},
+  {POWERFUNC, "power", {3.0, 4.0, 2.0, 0.0}},
+  {HORIZ_ELLIPSE, "horiz_ellipse", {3.0, 4.5, 0.0, 0.0}},
+  {ARCH, "arch", {3.0, 4.5, 0.0, 0.0}},
+  {EGGSHAPED, "egg", {3.0, 0.0, 0.0, 0.0}},
+  {HORSESHOE, "horseshoe", {3.0, 0.0, 0.0, 0.0}},
+  {GOTHIC, "gothic", {3.0, 0.0, 0.0, 0.0}},
+  {CATENARY, "catenary", {3.0, 0.0, 0.0, 0.0}},
+  {SEMIELLIPTICAL, "semielliptical", {3.0, 0.0, 0.0, 0.0}},
+  {BASKETHANDLE, "baskethandle", {3.0, 0.0, 0.0, 0.0}},
+  {SEMICIRCULAR, "semicircular", {3.0, 0.0, 0.0, 0.0}},
+};
+
+static const int BenchmarkTableSizes[] = {10, 100, 1000, 10000};
+
+static void addShapeRows()
+{
+  QTest::addColumn<int>("shape");
+
+  for(int i = 0; i < (int)(sizeof(BenchmarkShapes) / sizeof(BenchmarkShapes[0])); i++)
+  {
+    QTest::newRow(BenchmarkShapes[i].Name) << i;
+  }
+}
+
+static void setShape(Project *project, TXsect *xsect, int shape)
+{
+  double p[4];
+  memcpy(p, BenchmarkShapes[shape].Params, sizeof(p));
+  memset(xsect, 0, sizeof(TXsect));
+  QVERIFY(xsect_setParams(project, xsect, BenchmarkShapes[shape].Type, p, 1.0));
+}
+
+static void addTableSizeRows()
+{
+  QTest::addColumn<int>("size");
+
+  for(size_t i = 0; i < sizeof(BenchmarkTableSizes) / sizeof(BenchmarkTableSizes[0]); i++)
+  {
+    int size = BenchmarkTableSizes[i];
+    QTest::newRow(QByteArray::number(size).constData()) << size;
+  }
+}
+
+//table of size entries of a smooth, increasing curve over [0, size)
+static void fillTable(TTable *table, int size)
+{
+  table_init(table);
+
+  for(int i = 0; i < size; i++)
+  {
+    table_addEntry(table, i, sqrt((double)i) + 0.001 * i);
+  }
+
+  table_validate(table);
+  table_tseriesInit(table);
+}
+
+static int getExprVariable(Project *, char *name)
+{
+  if(QString(name).compare("x", Qt::CaseInsensitive) == 0) return 0;
+  if(QString(name).compare("y", Qt::CaseInsensitive) == 0) return 1;
+  return -1;
+}
+
+static double ExprValues[2];
+
+static double getExprValue(Project *, int index)
+{
+  return ExprValues[index];
+}
+
+QString SWMMBenchmarkClass::writeModel(const QString &name, const QString &infilModel, int nodes, int days)
+{
+  QString filePath = QDir::temp().filePath(name);
+  QFile file(filePath);
+
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    return QString();
+
+  QTextStream model(&file);
+  QDate endDate = QDate(2000, 1, 1).addDays(days);
+
+  model << "[TITLE]\nSWMM kernel benchmark model\n\n"
+        << "[OPTIONS]\n"
+        << "FLOW_UNITS CFS\n"
+        << "INFILTRATION " << infilModel << "\n"
+        << "FLOW_ROUTING DYNWAVE\n"
+        << "START_DATE 01/01/2000\nSTART_TIME 00:00:00\n"
+        << "REPORT_START_DATE 01/01/2000\nREPORT_START_TIME 00:00:00\n"
+        << "END_DATE " << endDate.toString("MM/dd/yyyy") << "\nEND_TIME 00:00:00\n"
+        << "WET_STEP 00:05:00\nDRY_STEP 01:00:00\nREPORT_STEP 01:00:00\nROUTING_STEP 0:00:10\n\n";
+
+  model << "[RAINGAGES]\nG1 INTENSITY 0:15 1.0 TIMESERIES Rain\n\n";
+
+  //one subcatchment, junction and conduit per node along a single trunk line
+  model << "[SUBCATCHMENTS]\n";
+  for(int i = 1; i <= nodes; i++)
+    model << "S" << i << " G1 J" << i << " 10 50 500 0.5 0\n";
+
+  model << "\n[SUBAREAS]\n";
+  for(int i = 1; i <= nodes; i++)
+    model << "S" << i << " 0.01 0.1 0.05 0.05 25 OUTLET\n";
+
+  model << "\n[INFILTRATION]\n";
+  for(int i = 1; i <= nodes; i++)
+  {
+    model << "S" << i << " ";
+
+    if(infilModel.contains("HORTON"))
+      model << "3.0 0.5 4 7 0\n";
+    else if(infilModel.contains("GREEN_AMPT"))
+      model << "3.5 0.5 0.25\n";
+    else
+      model << "80 0.5 7\n";
+  }
+
+  model << "\n[JUNCTIONS]\n";
+  for(int i = 1; i <= nodes; i++)
+    model << "J" << i << " " << 100.0 - 0.5 * i << " 10\n";
+
+  model << "\n[OUTFALLS]\nO1 " << 100.0 - 0.5 * (nodes + 1) << " FREE NO\n";
+
+  model << "\n[CONDUITS]\n";
+  for(int i = 1; i <= nodes; i++)
+  {
+    model << "C" << i << " J" << i << " ";
+    if(i < nodes) model << "J" << i + 1;
+    else model << "O1";
+    model << " 400 0.013 0 0 0 0\n";
+  }
+
+  model << "\n[XSECTIONS]\n";
+  for(int i = 1; i <= nodes; i++)
+    model << "C" << i << " CIRCULAR " << 1.0 + 0.05 * i << " 0 0 0 1\n";
+
+  model << "\n[HYDROGRAPHS]\nUH1 G1\n"
+        << "UH1 All Short 0.05 1 2\n"
+        << "UH1 All Medium 0.05 3 3\n"
+        << "UH1 All Long 0.05 10 10\n";
+
+  model << "\n[RDII]\n";
+  for(int i = 1; i <= nodes; i++)
+    model << "J" << i << " UH1 50\n";
+
+  //a 3 hour storm every other day
+  model << "\n[TIMESERIES]\n";
+  for(int day = 0; day < days; day += 2)
+  {
+    QString date = QDate(2000, 1, 1).addDays(day).toString("MM/dd/yyyy");
+
+    for(int k = 0; k <= 12; k++)
+    {
+      double rain = k < 12 ? 0.5 * sin(PI * (k + 0.5) / 12.0) : 0.0;
+      model << "Rain " << date << " " << QTime(6, 0).addSecs(900 * k).toString("hh:mm") << " " << rain << "\n";
+    }
+  }
+
+  return filePath;
+}
+
+void SWMMBenchmarkClass::initTestCase()
+{
+  //routing kernels are timed on the state of a model run for a simulated day
+  m_modelFile = writeModel("swmm_benchmark.inp", "HORTON", 50, 4);
+  QVERIFY(!m_modelFile.isEmpty());
+
+  QByteArray inputFile = m_modelFile.toLocal8Bit();
+  QByteArray reportFile = (m_modelFile + ".rpt").toLocal8Bit();
+  QByteArray outputFile = (m_modelFile + ".out").toLocal8Bit();
+
+  swmm_createProject(&m_project);
+  QVERIFY(swmm_open(m_project, inputFile.data(), reportFile.data(), outputFile.data()) == 0);
+  QVERIFY(swmm_start(m_project, 0) == 0);
+
+  double elapsedTime = 0.0;
+
+  do
+  {
+    QVERIFY(swmm_step(m_project, &elapsedTime) == 0);
+  } while(elapsedTime > 0.0 && elapsedTime < 1.0);
+}
+
+void SWMMBenchmarkClass::xsectGetAofY_data()
+{
+  addShapeRows();
+}
+
+void SWMMBenchmarkClass::xsectGetAofY()
+{
+  QFETCH(int, shape);
+
+  TXsect xsect;
+  setShape(m_project, &xsect, shape);
+  double dy = xsect.yFull / BatchSize;
+
+  QBENCHMARK
+  {
+    for(int i = 0; i < BatchSize; i++)
+      m_sink += xsect_getAofY(m_project, &xsect, (i + 0.5) * dy);
+  }
+}
+
+void SWMMBenchmarkClass::xsectGetYofA_data()
+{
+  addShapeRows();
+}
+
+void SWMMBenchmarkClass::xsectGetYofA()
+{
+  QFETCH(int, shape);
+
+  TXsect xsect;
+  setShape(m_project, &xsect, shape);
+  double da = xsect.aFull / BatchSize;
+
+  QBENCHMARK
+  {
+    for(int i = 0; i < BatchSize; i++)
+      m_sink += xsect_getYofA(m_project, &xsect, (i + 0.5) * da);
+  }
+}
+
+void SWMMBenchmarkClass::xsectGetRofA_data()
+{
+  addShapeRows();
+}
+
+void SWMMBenchmarkClass::xsectGetRofA()
+{
+  QFETCH(int, shape);
+
+  TXsect xsect;
+  setShape(m_project, &xsect, shape);
+  double da = xsect.aFull / BatchSize;
+
+  QBENCHMARK
+  {
+    for(int i = 0; i < BatchSize; i++)
+      m_sink += xsect_getRofA(m_project, &xsect, (i + 0.5) * da);
+  }
+}
+
+void SWMMBenchmarkClass::tableLookup_data()
+{
+  addTableSizeRows();
+}
+
+void SWMMBenchmarkClass::tableLookup()
+{
+  QFETCH(int, size);
+
+  TTable table;
+  fillTable(&table, size);
+
+  //scattered look ups, as made on storage and rating curves
+  QBENCHMARK
+  {
+    for(int i = 0; i < BatchSize; i++)
+      m_sink += table_lookup(&table, (double)((i * 7919) % BatchSize) * size / BatchSize);
+  }
+
+  table_deleteEntries(&table);
+}
+
+void SWMMBenchmarkClass::tableTseriesLookup_data()
+{
+  addTableSizeRows();
+}
+
+void SWMMBenchmarkClass::tableTseriesLookup()
+{
+  QFETCH(int, size);
+
+  TTable table;
+  fillTable(&table, size);
+
+  //look ups that advance through the series, as made while a run progresses
+  QBENCHMARK
+  {
+    table_tseriesInit(&table);
+
+    for(int i = 0; i < BatchSize; i++)
+      m_sink += table_tseriesLookup(&table, (i + 0.5) * size / BatchSize, TRUE);
+  }
+
+  table_deleteEntries(&table);
+}
+
+void SWMMBenchmarkClass::mathexprEval()
+{
+  char formula[] = "1.2*x^2 + sqrt(y)*exp(-x/10) - log(1+y)*sin(x) + abs(x-y)/(1+x*y)";
+  MathExpr *expr = mathexpr_create(m_project, formula, getExprVariable);
+  QVERIFY(expr != nullptr);
+
+  QBENCHMARK
+  {
+    for(int i = 0; i < BatchSize; i++)
+    {
+      ExprValues[0] = 0.001 * i;
+      ExprValues[1] = 2.0 + 0.0005 * i;
+      m_sink += mathexpr_eval(m_project, expr, getExprValue);
+    }
+  }
+
+  mathexpr_delete(expr);
+}
+
+void SWMMBenchmarkClass::dwflowFindConduitFlow()
+{
+  Project *project = m_project;
+  double dt = project->RouteStep;
+
+  QBENCHMARK
+  {
+    for(int i = 0; i < project->Nobjects[LINK]; i++)
+    {
+      if(project->Link[i].type == CONDUIT && project->Link[i].xsect.type != DUMMY)
+        dwflow_findConduitFlow(project, i, 1, 0.5, dt);
+    }
+  }
+}
+
+void SWMMBenchmarkClass::setNodeDepth()
+{
+  Project *project = m_project;
+  double dt = project->RouteStep;
+
+  QBENCHMARK
+  {
+    for(int i = 0; i < project->Nobjects[NODE]; i++)
+    {
+      if(project->Node[i].type != OUTFALL)
+        dynwave_setNodeDepth(project, i, dt);
+    }
+  }
+}
+
+void SWMMBenchmarkClass::infiltration_data()
+{
+  QTest::addColumn<QString>("model");
+
+  QTest::newRow("horton") << "HORTON";
+  QTest::newRow("modified_horton") << "MODIFIED_HORTON";
+  QTest::newRow("green_ampt") << "GREEN_AMPT";
+  QTest::newRow("modified_green_ampt") << "MODIFIED_GREEN_AMPT";
+  QTest::newRow("curve_number") << "CURVE_NUMBER";
+}
+
+void SWMMBenchmarkClass::infiltration()
+{
+  QFETCH(QString, model);
+
+  QString modelFile = writeModel("swmm_benchmark_infil.inp", model, 50, 2);
+  QByteArray inputFile = modelFile.toLocal8Bit();
+  QByteArray reportFile = (modelFile + ".rpt").toLocal8Bit();
+  QByteArray outputFile = (modelFile + ".out").toLocal8Bit();
+
+  Project *project = nullptr;
+  swmm_createProject(&project);
+  QVERIFY(swmm_open(project, inputFile.data(), reportFile.data(), outputFile.data()) == 0);
+  QVERIFY(swmm_start(project, 0) == 0);
+
+  int subcatchCount = project->Nobjects[SUBCATCH];
+  int steps = BatchSize / subcatchCount;
+  double tStep = project->WetStep;
+
+  //a storm followed by a dry period on a ponded surface
+  QBENCHMARK
+  {
+    for(int j = 0; j < subcatchCount; j++)
+      infil_initState(project, j, project->InfilModel);
+
+    for(int k = 0; k < steps; k++)
+    {
+      double rainfall = k < steps / 2 ? 0.5 / 12.0 / 3600.0 : 0.0;
+      double depth = k < steps / 2 ? 0.01 : 0.0;
+
+      for(int j = 0; j < subcatchCount; j++)
+        m_sink += infil_getInfil(project, j, project->InfilModel, tStep, rainfall, 0.0, depth);
+    }
+  }
+
+  swmm_end(project);
+  swmm_close(project);
+  swmm_deleteProject(project);
+}
+
+void SWMMBenchmarkClass::rdiiUnitHydConvol()
+{
+  //getUnitHydConvol is private to rdii.c and its unit hydrograph data only exists
+  //while swmm_start builds the RDII interface file, so this times that pass, in
+  //which the convolutions over a month of rainfall dominate
+  QString modelFile = writeModel("swmm_benchmark_rdii.inp", "HORTON", 50, 30);
+  QByteArray inputFile = modelFile.toLocal8Bit();
+  QByteArray reportFile = (modelFile + ".rpt").toLocal8Bit();
+  QByteArray outputFile = (modelFile + ".out").toLocal8Bit();
+
+  Project *project = nullptr;
+  swmm_createProject(&project);
+  QVERIFY(swmm_open(project, inputFile.data(), reportFile.data(), outputFile.data()) == 0);
+
+  QBENCHMARK
+  {
+    QVERIFY(swmm_start(project, 0) == 0);
+    swmm_end(project);
+  }
+
+  swmm_close(project);
+  swmm_deleteProject(project);
+}
+
+void SWMMBenchmarkClass::cleanupTestCase()
+{
+  if(m_project)
+  {
+    swmm_end(m_project);
+    swmm_close(m_project);
+    swmm_deleteProject(m_project);
+    m_project = nullptr;
+  }
+
+  QVERIFY(m_sink == m_sink);
+}
+
+#endif
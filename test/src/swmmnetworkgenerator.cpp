@@ -0,0 +1,373 @@
+/*!
+ * \file swmmnetworkgenerator.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+#ifdef SWMM_TEST
+
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "swmmnetworkgenerator.h"
+
+//conduit design values
+static const double ConduitLength = 400.0;      //ft
+static const double ConduitSlope = 0.004;
+static const double ConduitRoughness = 0.013;
+static const double LoopOffset = 0.5;          //ft, cross connections leave above the invert
+static const double DesignFlowPerNode = 1.0;   //cfs of peak runoff and dwf per junction
+
+struct GeneratedNode
+{
+    int Parent;          //node the outlet link drains to; -1 for the sewershed outfall
+    int Sewershed;
+    double Invert;       //ft
+    double Diameter;     //ft, outlet conduit
+    double DesignFlow;   //cfs, outlet link
+    bool Storage;
+    bool Pump;
+    bool Weir;
+};
+
+struct GeneratedLoop
+{
+    int Node1;
+    int Node2;
+    double Length;
+    double Diameter;
+};
+
+//uniform deviate in [0, 1) that does not depend on the standard library's distributions
+static double uniform(std::mt19937 &random)
+{
+  return random() / (std::mt19937::max() + 1.0);
+}
+
+//smallest quarter-foot circular diameter with a full flow capacity of at least flow
+static double designDiameter(double flow)
+{
+  //Manning's equation for a full pipe, Q = capacity * D^(8/3)
+  double capacity = 1.486 / ConduitRoughness * 0.7853981634 * pow(0.25, 2.0 / 3.0) * sqrt(ConduitSlope);
+  double diameter = pow(flow / capacity, 3.0 / 8.0);
+  return std::max(1.0, ceil(diameter * 4.0) / 4.0);
+}
+
+static void buildNetwork(const SWMMNetworkOptions &options, std::vector<GeneratedNode> &nodes, std::vector<GeneratedLoop> &loops)
+{
+  std::mt19937 random(options.Seed);
+  int sewershedSize = std::max(1, options.SewershedSize);
+
+  nodes.resize(std::max(1, options.Nodes));
+
+  for(int base = 0, sewershed = 0; base < (int)nodes.size(); base += sewershedSize, sewershed++)
+  {
+    int count = std::min(sewershedSize, (int)nodes.size() - base);
+
+    //each node drains to one of the few nodes generated just before it, which gives
+    //long trunk lines with short laterals rather than a balanced tree
+    for(int i = 0; i < count; i++)
+    {
+      GeneratedNode &node = nodes[base + i];
+      node.Sewershed = sewershed;
+      node.Parent = i == 0 ? -1 : base + i - 1 - (int)(random() % std::min(i, 8));
+      node.Invert = i == 0 ? 1.0 : nodes[node.Parent].Invert + ConduitLength * ConduitSlope;
+      node.DesignFlow = DesignFlowPerNode;
+      node.Storage = i > 0 && uniform(random) < options.StorageFraction;
+      node.Pump = node.Storage && uniform(random) < options.PumpFraction;
+      node.Weir = i > 0 && !node.Storage && uniform(random) < options.WeirFraction;
+    }
+
+    for(int i = count - 1; i > 0; i--)
+    {
+      nodes[nodes[base + i].Parent].DesignFlow += nodes[base + i].DesignFlow;
+    }
+
+    for(int i = 0; i < count; i++)
+    {
+      nodes[base + i].Diameter = designDiameter(nodes[base + i].DesignFlow);
+    }
+
+    if(options.Topology == LOOPED_NETWORK)
+    {
+      for(int i = 2; i < count; i++)
+      {
+        if(uniform(random) >= options.LoopFraction)
+          continue;
+
+        int j = base + i - 1 - (int)(random() % std::min(i, 16));
+
+        if(j == nodes[base + i].Parent)
+          continue;
+
+        //the cross connection drains from the higher node to the lower one
+        GeneratedLoop loop;
+        loop.Node1 = nodes[base + i].Invert >= nodes[j].Invert ? base + i : j;
+        loop.Node2 = loop.Node1 == j ? base + i : j;
+        loop.Length = std::max(ConduitLength, fabs(nodes[base + i].Invert - nodes[j].Invert) / 0.01);
+        loop.Diameter = std::min(nodes[base + i].Diameter, nodes[j].Diameter);
+        loops.push_back(loop);
+      }
+    }
+  }
+}
+
+//end date and time of a run of hours starting on 01/01/2000
+static void writeEndDate(FILE *file, int hours)
+{
+  static const int DaysPerMonth[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+  int day = hours / 24;
+  int month = 0;
+  int year = 2000;
+
+  while(day >= DaysPerMonth[month] + (month == 1 && year % 4 ? -1 : 0))
+  {
+    day -= DaysPerMonth[month] + (month == 1 && year % 4 ? -1 : 0);
+
+    if(++month == 12)
+    {
+      month = 0;
+      year++;
+    }
+  }
+
+  fprintf(file, "END_DATE             %02d/%02d/%04d\n", month + 1, day + 1, year);
+  fprintf(file, "END_TIME             %02d:00:00\n", hours % 24);
+}
+
+bool writeSWMMNetwork(const SWMMNetworkOptions &options, const std::string &fileName)
+{
+  std::vector<GeneratedNode> nodes;
+  std::vector<GeneratedLoop> loops;
+  buildNetwork(options, nodes, loops);
+
+  FILE *file = fopen(fileName.c_str(), "w");
+
+  if(file == nullptr)
+    return false;
+
+  int nodeCount = (int)nodes.size();
+  int sewersheds = nodes.back().Sewershed + 1;
+  int gages = options.RainGages > 0 ? options.RainGages : (sewersheds + 9) / 10;
+  int hours = std::max(1, options.Hours);
+
+  fprintf(file, "[TITLE]\nSynthetic %s network of %d nodes in %d sewersheds\n\n",
+          options.Topology == LOOPED_NETWORK ? "looped" : "dendritic", nodeCount, sewersheds);
+
+  fprintf(file, "[OPTIONS]\n");
+  fprintf(file, "FLOW_UNITS           CFS\n");
+  fprintf(file, "INFILTRATION         HORTON\n");
+  fprintf(file, "FLOW_ROUTING         DYNWAVE\n");
+  fprintf(file, "START_DATE           01/01/2000\n");
+  fprintf(file, "START_TIME           00:00:00\n");
+  fprintf(file, "REPORT_START_DATE    01/01/2000\n");
+  fprintf(file, "REPORT_START_TIME    00:00:00\n");
+  writeEndDate(file, hours);
+  fprintf(file, "WET_STEP             00:05:00\n");
+  fprintf(file, "DRY_STEP             01:00:00\n");
+  fprintf(file, "REPORT_STEP          00:15:00\n");
+  fprintf(file, "ROUTING_STEP         %g\n", options.RoutingStep);
+  fprintf(file, "THREADS              %d\n\n", options.Threads);
+
+  fprintf(file, "[REPORT]\nINPUT NO\nCONTROLS NO\n\n");
+
+  if(options.Rainfall)
+  {
+    //a triangular three hour storm each day whose start and peak vary by gage
+    std::mt19937 random(options.Seed + 1);
+
+    fprintf(file, "[RAINGAGES]\n");
+
+    for(int g = 1; g <= gages; g++)
+      fprintf(file, "G%d INTENSITY 0:15 1.0 TIMESERIES R%d\n", g, g);
+
+    fprintf(file, "\n[TIMESERIES]\n");
+
+    for(int g = 1; g <= gages; g++)
+    {
+      double start = 0.25 * (g % 4);
+      double peak = 0.5 + uniform(random);
+
+      for(int day = 0; day * 24 < hours; day++)
+      {
+        for(int k = 0; k <= 12; k++)
+        {
+          double rain = peak * (k <= 4 ? k / 4.0 : (12 - k) / 8.0);
+          fprintf(file, "R%d %.2f %.3f\n", g, day * 24 + start + 0.25 * k, rain);
+        }
+      }
+    }
+
+    fprintf(file, "\n[SUBCATCHMENTS]\n");
+
+    for(int i = 0; i < nodeCount; i++)
+    {
+      if(!nodes[i].Storage)
+        fprintf(file, "S%d G%d N%d 2 50 300 0.5 0\n", i + 1, nodes[i].Sewershed % gages + 1, i + 1);
+    }
+
+    fprintf(file, "\n[SUBAREAS]\n");
+
+    for(int i = 0; i < nodeCount; i++)
+    {
+      if(!nodes[i].Storage)
+        fprintf(file, "S%d 0.013 0.1 0.05 0.05 25 OUTLET\n", i + 1);
+    }
+
+    fprintf(file, "\n[INFILTRATION]\n");
+
+    for(int i = 0; i < nodeCount; i++)
+    {
+      if(!nodes[i].Storage)
+        fprintf(file, "S%d 3.0 0.5 4 7 0\n", i + 1);
+    }
+
+    fprintf(file, "\n");
+  }
+
+  fprintf(file, "[JUNCTIONS]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(!nodes[i].Storage)
+      fprintf(file, "N%d %.3f %.2f\n", i + 1, nodes[i].Invert, nodes[i].Diameter + 6.0);
+  }
+
+  //outfalls take a single link, so each overflow weir has its own
+  fprintf(file, "\n[OUTFALLS]\n");
+
+  for(int s = 0; s < sewersheds; s++)
+    fprintf(file, "O%d 0 FREE NO\n", s + 1);
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(nodes[i].Weir)
+      fprintf(file, "OW%d 0 FREE NO\n", i + 1);
+  }
+
+  fprintf(file, "\n[STORAGE]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(nodes[i].Storage)
+      fprintf(file, "N%d %.3f %.2f 0 FUNCTIONAL 0 0 2000 0 0\n", i + 1, nodes[i].Invert, nodes[i].Diameter + 10.0);
+  }
+
+  fprintf(file, "\n[CONDUITS]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(nodes[i].Pump)
+      continue;
+
+    fprintf(file, "C%d N%d ", i + 1, i + 1);
+
+    if(nodes[i].Parent < 0)
+      fprintf(file, "O%d", nodes[i].Sewershed + 1);
+    else
+      fprintf(file, "N%d", nodes[i].Parent + 1);
+
+    fprintf(file, " %g %g 0 0 0 0\n", ConduitLength, ConduitRoughness);
+  }
+
+  for(size_t k = 0; k < loops.size(); k++)
+  {
+    fprintf(file, "L%d N%d N%d %g %g %g 0 0 0\n", (int)k + 1, loops[k].Node1 + 1, loops[k].Node2 + 1,
+            loops[k].Length, ConduitRoughness, LoopOffset);
+  }
+
+  fprintf(file, "\n[PUMPS]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(nodes[i].Pump)
+      fprintf(file, "P%d N%d N%d PC%d ON 0 0\n", i + 1, i + 1, nodes[i].Parent + 1, i + 1);
+  }
+
+  fprintf(file, "\n[WEIRS]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(nodes[i].Weir)
+      fprintf(file, "W%d N%d OW%d TRANSVERSE %.2f 3.33 NO 0 0\n", i + 1, i + 1, i + 1, nodes[i].Diameter);
+  }
+
+  fprintf(file, "\n[XSECTIONS]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(!nodes[i].Pump)
+      fprintf(file, "C%d CIRCULAR %.2f 0 0 0 1\n", i + 1, nodes[i].Diameter);
+
+    if(nodes[i].Weir)
+      fprintf(file, "W%d RECT_OPEN 3 4 0 0\n", i + 1);
+  }
+
+  for(size_t k = 0; k < loops.size(); k++)
+    fprintf(file, "L%d CIRCULAR %.2f 0 0 0 1\n", (int)k + 1, loops[k].Diameter);
+
+  //pumps reach twice the outlet's design flow as the wet well fills
+  fprintf(file, "\n[CURVES]\n");
+
+  for(int i = 0; i < nodeCount; i++)
+  {
+    if(nodes[i].Pump)
+    {
+      fprintf(file, "PC%d PUMP4 0 0\n", i + 1);
+      fprintf(file, "PC%d 2 %.3f\n", i + 1, nodes[i].DesignFlow);
+      fprintf(file, "PC%d 6 %.3f\n", i + 1, 2.0 * nodes[i].DesignFlow);
+    }
+  }
+
+  if(options.DryWeatherFlow)
+  {
+    fprintf(file, "\n[DWF]\n");
+
+    for(int i = 0; i < nodeCount; i++)
+    {
+      if(!nodes[i].Storage)
+        fprintf(file, "N%d FLOW 0.02 DWF\n", i + 1);
+    }
+
+    fprintf(file, "\n[PATTERNS]\n");
+    fprintf(file, "DWF HOURLY 0.5 0.4 0.3 0.3 0.4 0.6 1.0 1.4 1.5 1.4 1.3 1.2\n");
+    fprintf(file, "DWF        1.2 1.1 1.0 1.0 1.1 1.2 1.4 1.5 1.4 1.2 0.9 0.7\n");
+  }
+
+  fprintf(file, "\n");
+
+  bool failed = ferror(file) != 0;
+  failed |= fclose(file) != 0;
+
+  return !failed;
+}
+
+bool parseSWMMNetworkTopology(const std::string &name, SWMMNetworkTopology *topology)
+{
+  if(name == "dendritic")
+    *topology = DENDRITIC_NETWORK;
+  else if(name == "looped")
+    *topology = LOOPED_NETWORK;
+  else
+    return false;
+
+  return true;
+}
+
+#endif
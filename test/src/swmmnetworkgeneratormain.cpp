@@ -0,0 +1,135 @@
+/*!
+ * \file swmmnetworkgeneratormain.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+
+#ifdef SWMM_TEST
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "swmmnetworkgenerator.h"
+
+static void printUsage(const char *program)
+{
+  printf("Usage: %s [options] <file.inp>\n"
+         "  -nodes <n>          number of nodes (10000)\n"
+         "  -sewershed <n>      nodes per sewershed (500)\n"
+         "  -topology <name>    dendritic or looped (dendritic)\n"
+         "  -loops <f>          cross connections per junction of looped networks (0.05)\n"
+         "  -storage <f>        fraction of nodes that are storage units (0.01)\n"
+         "  -pumps <f>          fraction of storage units drained by pumps (0.5)\n"
+         "  -weirs <f>          fraction of junctions with overflow weirs (0.01)\n"
+         "  -gages <n>          number of rain gages (one per 10 sewersheds)\n"
+         "  -hours <n>          simulation duration (6)\n"
+         "  -step <s>           routing step in seconds (5)\n"
+         "  -threads <n>        THREADS option (0)\n"
+         "  -seed <n>           random seed (1)\n"
+         "  -norain             no subcatchments or rainfall\n"
+         "  -nodwf              no dry weather flow\n", program);
+}
+
+int main(int argc, char** argv)
+{
+  SWMMNetworkOptions options;
+  const char *fileName = nullptr;
+
+  for(int i = 1; i < argc; i++)
+  {
+    const char *arg = argv[i];
+    const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+    bool hasValue = true;
+
+    if(!strcmp(arg, "-norain"))
+    {
+      options.Rainfall = false;
+      hasValue = false;
+    }
+    else if(!strcmp(arg, "-nodwf"))
+    {
+      options.DryWeatherFlow = false;
+      hasValue = false;
+    }
+    else if(arg[0] != '-')
+    {
+      fileName = arg;
+      hasValue = false;
+    }
+    else if(value == nullptr)
+    {
+      printUsage(argv[0]);
+      return 1;
+    }
+    else if(!strcmp(arg, "-nodes"))
+      options.Nodes = atoi(value);
+    else if(!strcmp(arg, "-sewershed"))
+      options.SewershedSize = atoi(value);
+    else if(!strcmp(arg, "-topology"))
+    {
+      if(!parseSWMMNetworkTopology(value, &options.Topology))
+      {
+        printUsage(argv[0]);
+        return 1;
+      }
+    }
+    else if(!strcmp(arg, "-loops"))
+      options.LoopFraction = atof(value);
+    else if(!strcmp(arg, "-storage"))
+      options.StorageFraction = atof(value);
+    else if(!strcmp(arg, "-pumps"))
+      options.PumpFraction = atof(value);
+    else if(!strcmp(arg, "-weirs"))
+      options.WeirFraction = atof(value);
+    else if(!strcmp(arg, "-gages"))
+      options.RainGages = atoi(value);
+    else if(!strcmp(arg, "-hours"))
+      options.Hours = atoi(value);
+    else if(!strcmp(arg, "-step"))
+      options.RoutingStep = atof(value);
+    else if(!strcmp(arg, "-threads"))
+      options.Threads = atoi(value);
+    else if(!strcmp(arg, "-seed"))
+      options.Seed = (unsigned int)strtoul(value, nullptr, 10);
+    else
+    {
+      printUsage(argv[0]);
+      return 1;
+    }
+
+    if(hasValue)
+      i++;
+  }
+
+  if(fileName == nullptr || options.Nodes < 1 || options.SewershedSize < 1 ||
+     options.Hours < 1 || options.RoutingStep <= 0.0)
+  {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  if(!writeSWMMNetwork(options, fileName))
+  {
+    fprintf(stderr, "Could not write %s\n", fileName);
+    return 1;
+  }
+
+  return 0;
+}
+
+#endif
@@ -0,0 +1,71 @@
+/*!
+ * \file swmmprocessmemory.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+#ifdef SWMM_TEST
+
+#include <QFile>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "swmmprocessmemory.h"
+
+void resetPeakMemory()
+{
+#if defined(__linux__)
+  QFile clearRefs("/proc/self/clear_refs");
+
+  if(clearRefs.open(QIODevice::WriteOnly))
+    clearRefs.write("5");
+#endif
+}
+
+double peakMemory()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize / 1048576.0;
+#elif defined(__APPLE__)
+  struct rusage usage;
+
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+    return usage.ru_maxrss / 1048576.0;
+#elif defined(__linux__)
+  QFile status("/proc/self/status");
+
+  if(status.open(QIODevice::ReadOnly | QIODevice::Text))
+  {
+    foreach(const QByteArray &line, status.readAll().split('\n'))
+    {
+      if(line.startsWith("VmHWM:"))
+        return line.mid(6).trimmed().split(' ').first().toDouble() / 1024.0;
+    }
+  }
+#endif
+
+  return 0.0;
+}
+
+#endif
@@ -0,0 +1,642 @@
+/*!
+ * \file swmmregressionclass.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+#ifdef SWMM_TEST
+
+#include <cmath>
+#include <omp.h>
+
+#include "swmm5.h"
+#include "headers.h"
+#include "swmmnetworkgenerator.h"
+#include "swmmprocessmemory.h"
+#include "swmmregressionclass.h"
+
+//run times below this many seconds are treated as timer noise
+static const double TimeNoiseFloor = 0.1;
+
+static QStringList environmentStrings(const char *name, const QStringList &defaults)
+{
+  QByteArray value = qgetenv(name);
+
+  if(value.isEmpty())
+    return defaults;
+
+  QStringList values;
+
+  foreach(const QByteArray &item, value.split(','))
+  {
+    if(!item.trimmed().isEmpty())
+      values.append(QString::fromLocal8Bit(item.trimmed()).toUpper());
+  }
+
+  return values;
+}
+
+static QList<int> environmentList(const char *name, const QList<int> &defaults)
+{
+  QList<int> values;
+
+  foreach(const QString &item, environmentStrings(name, QStringList()))
+  {
+    bool ok = false;
+    int number = item.toInt(&ok);
+
+    if(ok && number >= 0)
+      values.append(number);
+  }
+
+  return values.isEmpty() ? defaults : values;
+}
+
+static double environmentDouble(const char *name, double defaultValue)
+{
+  bool ok = false;
+  double value = qgetenv(name).trimmed().toDouble(&ok);
+
+  return ok && value >= 0.0 ? value : defaultValue;
+}
+
+//restores the working directory, which relative file names in the examples depend on
+class CurrentDirectory
+{
+  public:
+
+    explicit CurrentDirectory(const QString &path) : m_previous(QDir::currentPath())
+    {
+      QDir::setCurrent(path);
+    }
+
+    ~CurrentDirectory()
+    {
+      QDir::setCurrent(m_previous);
+    }
+
+  private:
+
+    QString m_previous;
+};
+
+QString SWMMRegressionClass::workingFile(const QString &model, const QString &routing)
+{
+  QString key = model + "/" + routing;
+
+  if(m_workingFiles.contains(key))
+    return m_workingFiles[key];
+
+  //each routing model gets its own copy of the example's directory, so files written
+  //by one run (e.g. a hot start file) are found by the next in the same directory
+  QFileInfo modelInfo(model);
+  QDir sourceDir = modelInfo.absoluteDir();
+  QDir targetDir(QDir(m_workingDir).filePath(routing + "/" + sourceDir.dirName()));
+
+  if(!targetDir.exists() && !QDir().mkpath(targetDir.absolutePath()))
+    return QString();
+
+  foreach(const QString &file, sourceDir.entryList(QDir::Files))
+  {
+    if(!targetDir.exists(file))
+      QFile::copy(sourceDir.filePath(file), targetDir.filePath(file));
+  }
+
+  QFile input(model);
+
+  if(!input.open(QIODevice::ReadOnly | QIODevice::Text))
+    return QString();
+
+  QStringList lines = QString::fromLocal8Bit(input.readAll()).split('\n');
+  input.close();
+
+  for(int i = 0; i < lines.size(); i++)
+  {
+    if(lines[i].trimmed().startsWith("FLOW_ROUTING", Qt::CaseInsensitive))
+      lines[i] = " FLOW_ROUTING          " + routing;
+  }
+
+  QString fileName = targetDir.filePath(modelInfo.fileName());
+  QFile output(fileName);
+
+  if(!output.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+    return QString();
+
+  output.write(lines.join('\n').toLocal8Bit());
+  m_workingFiles[key] = fileName;
+
+  return fileName;
+}
+
+//reference files hold one or more series, each an element ID on a line of its own
+//followed by "day hh:mm:ss value" lines
+QList<SWMMRegressionClass::ReferenceSeries> SWMMRegressionClass::readReferenceSeries(const QString &fileName)
+{
+  QList<ReferenceSeries> series;
+  QFile file(fileName);
+
+  if(!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    return series;
+
+  QRegularExpression valueLine("^\\s*(\\d+)\\s+(\\d+):(\\d+):(\\d+)\\s+(\\S+)");
+
+  while(!file.atEnd())
+  {
+    QString line = QString::fromLocal8Bit(file.readLine()).trimmed();
+    QRegularExpressionMatch match = valueLine.match(line);
+
+    if(match.hasMatch() && !series.isEmpty())
+    {
+      series.last().Times.append(match.captured(1).toInt() * 86400.0 + match.captured(2).toInt() * 3600.0 +
+                                 match.captured(3).toInt() * 60.0 + match.captured(4).toInt());
+      series.last().Values.append(match.captured(5).toDouble());
+    }
+    else if(!line.isEmpty())
+    {
+      ReferenceSeries reference;
+      reference.Id = line.split(QRegularExpression("\\s+")).first();
+      series.append(reference);
+    }
+  }
+
+  return series;
+}
+
+QString SWMMRegressionClass::resultRow(const QString &key, const RegressionResult &result)
+{
+  return QString("%1,%2,%3,%4,%5,%6,%7,%8,%9\n").arg(key)
+      .arg(result.Seconds, 0, 'g', 6).arg(result.Steps).arg(result.Iterations).arg(result.NonConverging)
+      .arg(result.ContinuityError, 0, 'f', 3)
+      .arg(result.ReferenceError < 0.0 ? QString() : QString::number(result.ReferenceError, 'f', 5))
+      .arg(result.PeakMemory, 0, 'f', 1).arg(result.ProjectMemory, 0, 'f', 3);
+}
+
+bool SWMMRegressionClass::parseResultRow(const QString &line, QString *key, RegressionResult *result)
+{
+  QStringList fields = line.trimmed().split(',');
+  bool ok = fields.size() == 11;
+
+  if(ok)
+  {
+    result->Seconds = fields[3].toDouble(&ok);
+    result->Steps = fields[4].toLong();
+    result->Iterations = fields[5].toLong();
+    result->NonConverging = fields[6].toLong();
+    result->ContinuityError = fields[7].toDouble();
+    result->ReferenceError = fields[8].isEmpty() ? -1.0 : fields[8].toDouble();
+    result->PeakMemory = fields[9].toDouble();
+    result->ProjectMemory = fields[10].toDouble();
+    *key = fields.mid(0, 3).join(',');
+  }
+
+  return ok;
+}
+
+void SWMMRegressionClass::initTestCase()
+{
+  m_examplesDir = qgetenv("SWMM_REGRESSION_EXAMPLES");
+
+  if(m_examplesDir.isEmpty())
+    m_examplesDir = "./../../examples";
+
+  m_examplesDir = QDir(m_examplesDir).absolutePath();
+
+  m_workingDir = QDir::temp().filePath("swmm_regression");
+  QDir(m_workingDir).removeRecursively();
+  QVERIFY(QDir().mkpath(m_workingDir));
+
+  m_timeTolerance = environmentDouble("SWMM_REGRESSION_TIME_TOLERANCE", 0.25);
+  m_countTolerance = environmentDouble("SWMM_REGRESSION_COUNT_TOLERANCE", 0.05);
+  m_memoryTolerance = environmentDouble("SWMM_REGRESSION_MEMORY_TOLERANCE", 0.25);
+  m_errorTolerance = environmentDouble("SWMM_REGRESSION_ERROR_TOLERANCE", 0.005);
+  m_continuityTolerance = environmentDouble("SWMM_REGRESSION_CONTINUITY_TOLERANCE", 0.5);
+  m_maxError = environmentDouble("SWMM_REGRESSION_MAX_ERROR", 0.15);
+
+  //examples whose legacy EXTRAN reference series dynamic wave routing has never
+  //matched that closely (extran6 by far the most)
+  m_modelMaxErrors.clear();
+  m_modelMaxErrors["EXTRAN3"] = 0.25;
+  m_modelMaxErrors["EXTRAN6"] = 5.0;
+  m_modelMaxErrors["EXTRAN8A"] = 1.0;
+  m_modelMaxErrors["USER2"] = 0.25;
+  m_modelMaxErrors["USER3"] = 0.25;
+  m_modelMaxErrors["USER5"] = 0.25;
+
+  foreach(const QString &item, environmentStrings("SWMM_REGRESSION_MODEL_MAX_ERRORS", QStringList()))
+  {
+    bool ok = false;
+    double limit = item.section('=', 1).toDouble(&ok);
+
+    if(ok && limit >= 0.0)
+      m_modelMaxErrors[item.section('=', 0, 0)] = limit;
+  }
+
+  //synthetic networks live in directories of their own, like the examples
+  foreach(int nodes, environmentList("SWMM_REGRESSION_NODES", QList<int>() << 1000))
+  {
+    if(nodes == 0)
+      continue;
+
+    QString dirName = QString("network_%1").arg(nodes);
+    QVERIFY(QDir(m_workingDir).mkpath("source/" + dirName));
+
+    SWMMNetworkOptions options;
+    options.Nodes = nodes;
+    options.Hours = 1;
+
+    QString fileName = QDir(m_workingDir).filePath("source/" + dirName + "/" + dirName + ".inp");
+    QVERIFY(writeSWMMNetwork(options, fileName.toStdString()));
+    m_networks.append(fileName);
+  }
+
+  m_csvFile = qgetenv("SWMM_REGRESSION_CSV");
+
+  if(m_csvFile.isEmpty())
+    m_csvFile = QDir::temp().filePath("swmm_regression.csv");
+
+  QFile csv(m_csvFile);
+  QVERIFY(csv.open(QIODevice::WriteOnly | QIODevice::Text));
+
+  QTextStream(&csv) << "model,routing,threads,seconds,steps,iterations,non_converging,"
+                       "continuity_error,reference_error,peak_memory_mb,project_memory_mb\n";
+
+  m_baselineFile = qgetenv("SWMM_REGRESSION_BASELINE");
+
+  if(m_baselineFile.isEmpty())
+    m_baselineFile = QDir(m_examplesDir).filePath("swmm_regression_baseline.csv");
+
+  m_updateBaseline = !qgetenv("SWMM_REGRESSION_UPDATE").isEmpty();
+
+  if(m_updateBaseline)
+  {
+    qDebug("Writing the baseline %s", qPrintable(m_baselineFile));
+    return;
+  }
+
+  QFile baseline(m_baselineFile);
+  QVERIFY2(baseline.open(QIODevice::ReadOnly | QIODevice::Text),
+           qPrintable("No baseline " + m_baselineFile + "; set SWMM_REGRESSION_UPDATE to write one"));
+
+  while(!baseline.atEnd())
+  {
+    QString key;
+    RegressionResult result;
+
+    if(parseResultRow(QString::fromLocal8Bit(baseline.readLine()), &key, &result))
+      m_baseline[key] = result;
+  }
+}
+
+void SWMMRegressionClass::regression_data()
+{
+  QTest::addColumn<QString>("model");
+  QTest::addColumn<QString>("reference");
+  QTest::addColumn<QString>("routing");
+  QTest::addColumn<int>("threads");
+
+  QList<int> defaultThreads = QList<int>() << 1;
+
+  if(omp_get_max_threads() > 1)
+    defaultThreads.append(omp_get_max_threads());
+
+  QStringList routings = environmentStrings("SWMM_REGRESSION_ROUTING",
+                                            QStringList() << "DYNWAVE" << "KINWAVE" << "STEADY");
+  QList<int> threadCounts = environmentList("SWMM_REGRESSION_THREADS", defaultThreads);
+
+  //runs with more threads are checked against the 1 thread run, so it always comes first
+  threadCounts.removeAll(1);
+  threadCounts.prepend(1);
+
+  //models and their reference series; the examples are taken in name order so that
+  //one which saves a hot start file (extran8a) runs before the one using it (extran8b)
+  QList<QPair<QString, QString>> models;
+  QDir examplesDir(m_examplesDir);
+
+  foreach(const QString &dirName, examplesDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+  {
+    QDir dir(examplesDir.filePath(dirName));
+
+    foreach(const QString &fileName, dir.entryList(QStringList() << "*.inp", QDir::Files, QDir::Name))
+    {
+      QString reference = dir.filePath(QFileInfo(fileName).completeBaseName());
+
+      //variants of an example (extran8a, extran8b) share its reference series
+      if(!QFile::exists(reference + "_q.dat") && !QFile::exists(reference + "_y.dat") &&
+         reference.at(reference.size() - 1).isLetter())
+        reference.chop(1);
+
+      models.append(qMakePair(dir.filePath(fileName), reference));
+    }
+  }
+
+  foreach(const QString &network, m_networks)
+    models.append(qMakePair(network, QString()));
+
+  foreach(const QString &routing, routings)
+  {
+    for(int i = 0; i < models.size(); i++)
+    {
+      foreach(int threads, threadCounts)
+      {
+        QString name = QString("%1/%2/%3t").arg(QFileInfo(models[i].first).completeBaseName())
+                       .arg(routing).arg(threads);
+
+        QTest::newRow(name.toLocal8Bit().constData()) << models[i].first << models[i].second
+                                                      << routing << threads;
+      }
+    }
+  }
+}
+
+void SWMMRegressionClass::regression()
+{
+  QFETCH(QString, model);
+  QFETCH(QString, reference);
+  QFETCH(QString, routing);
+  QFETCH(int, threads);
+
+  if(threads > omp_get_max_threads())
+    QSKIP("More threads than processors");
+
+  QString inputPath = workingFile(model, routing);
+  QVERIFY2(!inputPath.isEmpty(), qPrintable("Could not copy " + model));
+
+  CurrentDirectory currentDirectory(QFileInfo(inputPath).absolutePath());
+
+  //reference series of link flows (index 0) and node depths (index 1)
+  QList<ReferenceSeries> references[2];
+
+  if(!reference.isEmpty())
+  {
+    references[0] = readReferenceSeries(reference + "_q.dat");
+    references[1] = readReferenceSeries(reference + "_y.dat");
+  }
+
+  QByteArray inputFile = inputPath.toLocal8Bit();
+  QByteArray reportFile = (inputPath + ".rpt").toLocal8Bit();
+  QByteArray outputFile = (inputPath + ".out").toLocal8Bit();
+
+  resetPeakMemory();
+
+  Project *project = nullptr;
+  swmm_createProject(&project);
+
+  int error = swmm_open(project, inputFile.data(), reportFile.data(), outputFile.data());
+
+  //not every example can be routed by every model (e.g. kinematic wave
+  //routing rejects adverse slopes and nodes with several outlets)
+  if(error && routing != "DYNWAVE")
+  {
+    swmm_close(project);
+    swmm_deleteProject(project);
+    QSKIP(qPrintable(QString("Cannot be routed by %1 (error %2)").arg(routing).arg(error)));
+  }
+
+  QVERIFY2(error == 0, qPrintable(QString("swmm_open error %1").arg(error)));
+
+  if(threads > 1 && project->Nobjects[LINK] < 4 * threads)
+  {
+    swmm_close(project);
+    swmm_deleteProject(project);
+    QSKIP("Too few links for the number of threads");
+  }
+
+  project->NumThreads = threads;
+  project->PerfStats = TRUE;
+
+  //the reference elements must be reported for their results to be saved
+  QList<int> indices[2];
+
+  for(int k = 0; k < 2; k++)
+  {
+    foreach(const ReferenceSeries &series, references[k])
+    {
+      QByteArray id = series.Id.toLocal8Bit();
+      int index = project_findObject(project, k ? NODE : LINK, id.data());
+
+      if(index < 0)
+        qDebug("%s is not in %s", id.constData(), qPrintable(QFileInfo(model).fileName()));
+      else if(k)
+        project->Node[index].rptFlag = TRUE;
+      else
+        project->Link[index].rptFlag = TRUE;
+
+      indices[k].append(index);
+    }
+  }
+
+  RegressionResult result;
+  QElapsedTimer timer;
+  timer.start();
+
+  error = swmm_start(project, TRUE);
+
+  //the network checks of the simpler routing models are made on starting
+  if(error && routing != "DYNWAVE")
+  {
+    swmm_end(project);
+    swmm_close(project);
+    swmm_deleteProject(project);
+    QSKIP(qPrintable(QString("Cannot be routed by %1 (error %2)").arg(routing).arg(error)));
+  }
+
+  QVERIFY2(error == 0, qPrintable(QString("swmm_start error %1").arg(error)));
+
+  double elapsedTime = 0.0;
+
+  do
+  {
+    QVERIFY(swmm_step(project, &elapsedTime) == 0);
+  } while(elapsedTime > 0.0);
+
+  for(int type = 0; type < MAX_MEMORY_TYPES; type++)
+  {
+    double bytes = 0.0;
+    QVERIFY(swmm_getMemoryUse(project, type, &bytes) == 0);
+    result.ProjectMemory += bytes / 1048576.0;
+  }
+
+  QVERIFY(swmm_end(project) == 0);
+  result.Seconds = timer.nsecsElapsed() * 1.0e-9;
+
+  double time;
+  long calls;
+  QVERIFY(swmm_getPerfStats(project, PERF_FLOW_ROUTING, &time, &calls, &result.Iterations) == 0);
+
+  result.Steps = project->StepCount;
+  result.NonConverging = project->NonConvergeCount;
+
+  float runoffError, flowError, qualityError;
+  swmm_getMassBalErr(project, &runoffError, &flowError, &qualityError);
+  result.ContinuityError = flowError;
+
+  //worst mean absolute error over the series, each as a fraction of its peak; results
+  //are read back from the output file, where an element's place among the reported
+  //elements of its type is its index
+  for(int k = 0; k < 2; k++)
+  {
+    for(int s = 0; s < references[k].size(); s++)
+    {
+      const ReferenceSeries &series = references[k][s];
+      int index = indices[k][s];
+
+      if(index < 0)
+        continue;
+
+      int reportIndex = 0;
+
+      for(int i = 0; i < index; i++)
+      {
+        if(k ? project->Node[i].rptFlag : project->Link[i].rptFlag)
+          reportIndex++;
+      }
+
+      double peak = 0.0, sum = 0.0;
+      int count = 0;
+
+      for(int i = 0; i < series.Times.size(); i++)
+      {
+        int period = (int)std::floor(series.Times[i] / project->ReportStep + 0.5);
+
+        if(period < 1 || period > project->Nperiods)
+          continue;
+
+        double value;
+
+        if(k)
+        {
+          output_readNodeResults(project, period, reportIndex);
+          value = project->NodeResults[NODE_DEPTH];
+        }
+        else
+        {
+          output_readLinkResults(project, period, reportIndex);
+          value = project->LinkResults[LINK_FLOW];
+        }
+
+        peak = qMax(peak, std::fabs(series.Values[i]));
+        sum += std::fabs(value - series.Values[i]);
+        count++;
+      }
+
+      if(count && peak > 0.0)
+        result.ReferenceError = qMax(result.ReferenceError, sum / count / peak);
+    }
+  }
+
+  swmm_close(project);
+  swmm_deleteProject(project);
+
+  result.PeakMemory = peakMemory();
+
+  QString key = QString("%1,%2,%3").arg(QFileInfo(model).completeBaseName()).arg(routing).arg(threads);
+  m_results.append(qMakePair(key, result));
+
+  QFile csv(m_csvFile);
+  QVERIFY(csv.open(QIODevice::Append | QIODevice::Text));
+  QTextStream(&csv) << resultRow(key, result);
+  csv.close();
+
+  qDebug("%.3f s, %ld steps, %ld iterations, %.3f %% continuity error, %.4f reference error",
+         result.Seconds, result.Steps, result.Iterations, result.ContinuityError, result.ReferenceError);
+
+  QStringList failures;
+
+  //the reference series are EXTRAN results, which only dynamic wave routing is expected to match
+  double maxError = m_modelMaxErrors.value(QFileInfo(model).completeBaseName().toUpper(), m_maxError);
+
+  if(routing == "DYNWAVE" && maxError > 0.0 && result.ReferenceError > maxError)
+    failures << QString("reference error %1 above %2").arg(result.ReferenceError).arg(maxError);
+
+  //threads only share out the work, so they must not change the solution
+  if(threads > 1)
+  {
+    QString serialKey = QString("%1,%2,1").arg(QFileInfo(model).completeBaseName()).arg(routing);
+    bool found = false;
+
+    for(int i = 0; i < m_results.size() && !found; i++)
+    {
+      if(m_results[i].first != serialKey)
+        continue;
+
+      const RegressionResult &serial = m_results[i].second;
+      found = true;
+
+      if(result.Steps != serial.Steps || result.Iterations != serial.Iterations ||
+         result.NonConverging != serial.NonConverging ||
+         result.ContinuityError != serial.ContinuityError ||
+         result.ReferenceError != serial.ReferenceError)
+        failures << QString("%1 steps, %2 iterations, %3 non-converging, %4 % continuity error, "
+                            "%5 reference error against %6, %7, %8, %9 %, %10 at 1 thread")
+                    .arg(result.Steps).arg(result.Iterations).arg(result.NonConverging)
+                    .arg(result.ContinuityError).arg(result.ReferenceError)
+                    .arg(serial.Steps).arg(serial.Iterations).arg(serial.NonConverging)
+                    .arg(serial.ContinuityError).arg(serial.ReferenceError);
+    }
+
+    if(!found)
+      failures << "no 1 thread run to compare with";
+  }
+
+  if(!m_updateBaseline && m_baseline.contains(key))
+  {
+    const RegressionResult &baseline = m_baseline[key];
+
+    if(result.Seconds > baseline.Seconds * (1.0 + m_timeTolerance) + TimeNoiseFloor)
+      failures << QString("%1 s against %2 s").arg(result.Seconds).arg(baseline.Seconds);
+
+    if(result.Steps > baseline.Steps * (1.0 + m_countTolerance))
+      failures << QString("%1 steps against %2").arg(result.Steps).arg(baseline.Steps);
+
+    if(result.Iterations > baseline.Iterations * (1.0 + m_countTolerance))
+      failures << QString("%1 iterations against %2").arg(result.Iterations).arg(baseline.Iterations);
+
+    if(baseline.ReferenceError >= 0.0 && result.ReferenceError > baseline.ReferenceError + m_errorTolerance)
+      failures << QString("reference error %1 against %2").arg(result.ReferenceError).arg(baseline.ReferenceError);
+
+    if(std::fabs(result.ContinuityError) > std::fabs(baseline.ContinuityError) + m_continuityTolerance)
+      failures << QString("continuity error %1 %% against %2 %%").arg(result.ContinuityError).arg(baseline.ContinuityError);
+
+    if(result.ProjectMemory > baseline.ProjectMemory * (1.0 + m_memoryTolerance))
+      failures << QString("%1 MB against %2 MB").arg(result.ProjectMemory).arg(baseline.ProjectMemory);
+  }
+  else if(!m_updateBaseline && threads == 1)
+  {
+    qDebug("No baseline for %s", qPrintable(key));
+  }
+
+  QVERIFY2(failures.isEmpty(), qPrintable(failures.join(", ")));
+}
+
+void SWMMRegressionClass::cleanupTestCase()
+{
+  if(m_updateBaseline)
+  {
+    QFile baseline(m_baselineFile);
+    QVERIFY(baseline.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate));
+
+    QTextStream stream(&baseline);
+    stream << "model,routing,threads,seconds,steps,iterations,non_converging,"
+              "continuity_error,reference_error,peak_memory_mb,project_memory_mb\n";
+
+    for(int i = 0; i < m_results.size(); i++)
+      stream << resultRow(m_results[i].first, m_results[i].second);
+  }
+
+  QDir(m_workingDir).removeRecursively();
+}
+
+#endif
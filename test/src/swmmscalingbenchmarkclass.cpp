@@ -0,0 +1,255 @@
+/*!
+ * \file swmmscalingbenchmarkclass.cpp
+ * \author Caleb Amoa Buahin <caleb.buahin@gmail.com>
+ * \version 5.1.012
+ * \description
+ * \license
+ * This file and its associated files, and libraries are free software.
+ * You can redistribute it and/or modify it under the terms of the
+ * Lesser GNU Lesser General Public License as published by the Free Software Foundation;
+ * either version 3 of the License, or (at your option) any later version.
+ * This file and its associated files is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.(see <http://www.gnu.org/licenses/> for details)
+ * \copyright Copyright 2014-2018, Caleb Buahin, All rights reserved.
+ * \date 2014-2018
+ * \pre
+ * \bug
+ * \warning
+ * \todo
+ */
+#ifdef SWMM_TEST
+
+#include <algorithm>
+#include <omp.h>
+
+#include "swmm5.h"
+#include "headers.h"
+#include "swmmnetworkgenerator.h"
+#include "swmmprocessmemory.h"
+#include "swmmscalingbenchmarkclass.h"
+
+static const char *PerfPhaseNames[MAX_PERF_PHASES] =
+{
+  "step", "runoff", "routing", "controls", "inflows", "flow_routing",
+  "quality_routing", "losses", "flow_stats", "output", "checkpoint"
+};
+
+static QList<int> environmentList(const char *name, const QList<int> &defaults)
+{
+  QByteArray value = qgetenv(name);
+
+  if(value.isEmpty())
+    return defaults;
+
+  QList<int> values;
+
+  foreach(const QByteArray &item, value.split(','))
+  {
+    bool ok = false;
+    int number = item.trimmed().toInt(&ok);
+
+    if(ok && number > 0)
+      values.append(number);
+  }
+
+  return values;
+}
+
+QString SWMMScalingBenchmarkClass::modelFile(int topology, int nodes)
+{
+  QString name = QString("swmm_scaling_%1_%2_%3h.inp")
+                 .arg(topology == LOOPED_NETWORK ? "looped" : "dendritic")
+                 .arg(nodes).arg(m_hours);
+
+  return QDir::temp().filePath(name);
+}
+
+void SWMMScalingBenchmarkClass::initTestCase()
+{
+  QList<int> hours = environmentList("SWMM_SCALING_HOURS", QList<int>() << 1);
+  m_hours = hours.isEmpty() ? 1 : hours.first();
+
+  m_csvFile = qgetenv("SWMM_SCALING_CSV");
+
+  if(m_csvFile.isEmpty())
+    m_csvFile = QDir::temp().filePath("swmm_scaling.csv");
+
+  QFile csv(m_csvFile);
+  QVERIFY(csv.open(QIODevice::WriteOnly | QIODevice::Text));
+
+  QTextStream(&csv) << "topology,nodes,threads,phase,seconds_per_simulated_hour,"
+                       "calls,iterations,parallel_efficiency,peak_memory_mb\n";
+}
+
+void SWMMScalingBenchmarkClass::scaling_data()
+{
+  QTest::addColumn<int>("topology");
+  QTest::addColumn<int>("nodes");
+  QTest::addColumn<int>("threads");
+
+  QList<int> defaultThreads;
+
+  for(int threads = 1; threads < omp_get_max_threads(); threads *= 2)
+    defaultThreads.append(threads);
+
+  defaultThreads.append(omp_get_max_threads());
+
+  QList<int> sizes = environmentList("SWMM_SCALING_NODES", QList<int>() << 1000 << 10000);
+  QList<int> threadCounts = environmentList("SWMM_SCALING_THREADS", defaultThreads);
+  std::sort(sizes.begin(), sizes.end());
+  std::sort(threadCounts.begin(), threadCounts.end());
+
+  //single thread runs come first so that the others can be compared with them
+  for(int topology = DENDRITIC_NETWORK; topology <= LOOPED_NETWORK; topology++)
+  {
+    foreach(int nodes, sizes)
+    {
+      foreach(int threads, threadCounts)
+      {
+        QString name = QString("%1/%2/%3t").arg(topology == LOOPED_NETWORK ? "looped" : "dendritic")
+                       .arg(nodes).arg(threads);
+
+        QTest::newRow(name.toLocal8Bit().constData()) << topology << nodes << threads;
+      }
+    }
+  }
+}
+
+void SWMMScalingBenchmarkClass::scaling()
+{
+  QFETCH(int, topology);
+  QFETCH(int, nodes);
+  QFETCH(int, threads);
+
+  if(threads > omp_get_max_threads())
+    QSKIP("More threads than processors");
+
+  QString inputPath = modelFile(topology, nodes);
+
+  if(!m_models.contains(inputPath))
+  {
+    SWMMNetworkOptions options;
+    options.Nodes = nodes;
+    options.Topology = (SWMMNetworkTopology)topology;
+    options.Hours = m_hours;
+
+    QVERIFY(writeSWMMNetwork(options, inputPath.toStdString()));
+    m_models.insert(inputPath);
+  }
+
+  QByteArray inputFile = inputPath.toLocal8Bit();
+  QByteArray reportFile = (inputPath + ".rpt").toLocal8Bit();
+  QByteArray outputFile = (inputPath + ".out").toLocal8Bit();
+
+  resetPeakMemory();
+
+  //phase name and seconds, calls and iterations of each timed part of the run
+  QList<QString> phases;
+  QList<double> times;
+  QList<long> calls;
+  QList<long> iterations;
+  QElapsedTimer timer;
+  Project *project = nullptr;
+  swmm_createProject(&project);
+
+  timer.start();
+  QVERIFY(swmm_open(project, inputFile.data(), reportFile.data(), outputFile.data()) == 0);
+  phases << "open";
+  times << timer.nsecsElapsed() * 1.0e-9;
+
+  if(project->Nobjects[LINK] < 4 * threads)
+  {
+    swmm_close(project);
+    swmm_deleteProject(project);
+    QSKIP("Too few links for the number of threads");
+  }
+
+  project->NumThreads = threads;
+  project->PerfStats = TRUE;
+
+  timer.restart();
+  QVERIFY(swmm_start(project, 0) == 0);
+  phases << "start";
+  times << timer.nsecsElapsed() * 1.0e-9;
+
+  double elapsedTime = 0.0;
+  timer.restart();
+
+  do
+  {
+    QVERIFY(swmm_step(project, &elapsedTime) == 0);
+  } while(elapsedTime > 0.0);
+
+  phases << "run";
+  times << timer.nsecsElapsed() * 1.0e-9;
+
+  timer.restart();
+  QVERIFY(swmm_end(project) == 0);
+  phases << "end";
+  times << timer.nsecsElapsed() * 1.0e-9;
+
+  phases << "total";
+  times << times[0] + times[1] + times[2] + times[3];
+
+  for(int i = 0; i < phases.size(); i++)
+  {
+    calls << 1;
+    iterations << 0;
+  }
+
+  for(int phase = 0; phase < MAX_PERF_PHASES; phase++)
+  {
+    double time;
+    long phaseCalls, phaseIterations;
+    QVERIFY(swmm_getPerfStats(project, phase, &time, &phaseCalls, &phaseIterations) == 0);
+
+    phases << PerfPhaseNames[phase];
+    times << time;
+    calls << phaseCalls;
+    iterations << phaseIterations;
+  }
+
+  swmm_close(project);
+  swmm_deleteProject(project);
+
+  double memory = peakMemory();
+  double total = times[4] / m_hours;
+
+  QFile csv(m_csvFile);
+  QVERIFY(csv.open(QIODevice::Append | QIODevice::Text));
+  QTextStream results(&csv);
+
+  for(int i = 0; i < phases.size(); i++)
+  {
+    double perHour = times[i] / m_hours;
+    QString key = QString("%1/%2/%3").arg(topology).arg(nodes).arg(phases[i]);
+    QString efficiency;
+
+    if(threads == 1)
+      m_serialTimes[key] = perHour;
+
+    if(m_serialTimes.contains(key) && perHour > 0.0)
+      efficiency = QString::number(m_serialTimes[key] / (threads * perHour), 'f', 3);
+
+    results << (topology == LOOPED_NETWORK ? "looped" : "dendritic") << "," << nodes << ","
+            << threads << "," << phases[i] << "," << QString::number(perHour, 'g', 6) << ","
+            << calls[i] << "," << iterations[i] << "," << efficiency << ","
+            << QString::number(memory, 'f', 1) << "\n";
+  }
+
+  qDebug("%d nodes, %d threads: %.3f s per simulated hour, %.1f MB peak", nodes, threads, total, memory);
+
+  QTest::setBenchmarkResult(total * 1000.0, QTest::WalltimeMilliseconds);
+}
+
+void SWMMScalingBenchmarkClass::cleanupTestCase()
+{
+  foreach(const QString &model, m_models)
+  {
+    QFile::remove(model);
+    QFile::remove(model + ".rpt");
+    QFile::remove(model + ".out");
+  }
+}
+
+#endif
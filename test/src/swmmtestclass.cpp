@@ -20,9 +20,12 @@
 #ifdef SWMM_TEST
 
 #include <omp.h>
+#include <atomic>
+#include <thread>
 
 #include "swmm5.h"
 #include "headers.h"
+#include "dataexchangecache.h"
 #include "swmmtestclass.h"
 
 void SWMMTestClass::init()
@@ -35,8 +38,10 @@ void SWMMTestClass::concurrentSameInput()
   QBENCHMARK
   {
     {
-      Project *project1 = swmm_createProject();
-      Project *project2 = swmm_createProject();
+      Project *project1 = nullptr;
+      swmm_createProject(&project1);
+      Project *project2 = nullptr;
+      swmm_createProject(&project2);
 
 #pragma omp parallel sections
       {
@@ -99,7 +104,8 @@ void SWMMTestClass::concurrentDifferentInputs()
 {
   QBENCHMARK
   {
-    Project *project1 = swmm_createProject();
+    Project *project1 = nullptr;
+    swmm_createProject(&project1);
 
     std::string inpuFileStr = "./../../examples/test1/test1.inp";
     char *inputFile = new char[inpuFileStr.size() + 1];
@@ -125,6 +131,296 @@ void SWMMTestClass::concurrentDifferentInputs()
   }
 }
 
+Project *SWMMTestClass::startExample(const QString &name)
+{
+  QByteArray inputFile = QString("./../../examples/%1/%1.inp").arg(name).toLocal8Bit();
+  QByteArray reportFile = QString("./../../examples/%1/%1_state.rpt").arg(name).toLocal8Bit();
+  QByteArray outputFile = QString("./../../examples/%1/%1_state.out").arg(name).toLocal8Bit();
+
+  Project *project = nullptr;
+  swmm_createProject(&project);
+
+  if(swmm_open(project, inputFile.data(), reportFile.data(), outputFile.data()) ||
+     swmm_start(project, FALSE))
+  {
+    swmm_close(project);
+    swmm_deleteProject(project);
+    return nullptr;
+  }
+
+  return project;
+}
+
+//elapsed time, node depths and link flows after each of the next steps
+//(all remaining steps if steps is negative)
+QVector<double> SWMMTestClass::stepResults(Project *project, int steps)
+{
+  QVector<double> results;
+  double elapsedTime = 0.0;
+
+  for(int step = 0; steps < 0 || step < steps; step++)
+  {
+    if(swmm_step(project, &elapsedTime))
+      break;
+
+    results.append(elapsedTime);
+
+    for(int i = 0; i < project->Nobjects[NODE]; i++)
+      results.append(project->Node[i].newDepth);
+
+    for(int i = 0; i < project->Nobjects[LINK]; i++)
+      results.append(project->Link[i].newFlow);
+
+    if(elapsedTime == 0.0)
+      break;
+  }
+
+  return results;
+}
+
+void SWMMTestClass::restoreState_data()
+{
+  QTest::addColumn<QString>("name");
+
+  QTest::newRow("user1") << "user1";
+  QTest::newRow("test3") << "test3";
+}
+
+void SWMMTestClass::restoreState()
+{
+  QFETCH(QString, name);
+
+  Project *project = startExample(name);
+  QVERIFY(project != nullptr);
+
+  stepResults(project, 500);
+
+  size_t size = 0;
+  QVERIFY(swmm_getStateSize(project, &size) == 0);
+  QByteArray state((int)size, 0);
+  QVERIFY(swmm_saveState(project, state.data(), size) == 0);
+
+  QVector<double> saved = stepResults(project, 1000);
+
+  QVERIFY(swmm_restoreState(project, state.constData(), size) == 0);
+  QVector<double> restored = stepResults(project, 1000);
+
+  QVERIFY(project->ErrorCode == 0);
+  QCOMPARE(saved.size(), restored.size());
+  QVERIFY2(saved == restored, "Results after a restore differ from those after the save");
+
+  swmm_end(project);
+  swmm_close(project);
+  swmm_deleteProject(project);
+}
+
+void SWMMTestClass::forksMatch()
+{
+  Project *project = startExample("user1");
+  QVERIFY(project != nullptr);
+
+  stepResults(project, 500);
+
+  Project *forks[2];
+  QVERIFY(swmm_fork(project, 2, forks) == 0);
+
+  QVector<double> first = stepResults(forks[0], -1);
+  QVector<double> second = stepResults(forks[1], -1);
+  QVector<double> parent = stepResults(project, -1);
+
+  QVERIFY(forks[0]->ErrorCode == 0 && forks[1]->ErrorCode == 0);
+  QVERIFY2(first == second, "Forks from the same state differ");
+  QVERIFY2(first == parent, "A fork differs from its parent");
+
+  for(int i = 0; i < 2; i++)
+  {
+    swmm_close(forks[i]);
+    swmm_deleteProject(forks[i]);
+  }
+
+  swmm_end(project);
+  swmm_close(project);
+  swmm_deleteProject(project);
+}
+
+void SWMMTestClass::forksOnThreads()
+{
+  Project *project = startExample("test3");
+  QVERIFY(project != nullptr);
+
+  stepResults(project, 500);
+
+  Project *forks[3];
+  QVERIFY(swmm_fork(project, 3, forks) == 0);
+
+  QVector<double> results[3];
+  std::thread threads[3];
+
+  for(int i = 0; i < 3; i++)
+    threads[i] = std::thread([&results, &forks, i]() { results[i] = stepResults(forks[i], -1); });
+
+  QVector<double> parent = stepResults(project, -1);
+
+  for(int i = 0; i < 3; i++)
+    threads[i].join();
+
+  for(int i = 0; i < 3; i++)
+  {
+    QVERIFY(forks[i]->ErrorCode == 0);
+    QVERIFY2(results[i] == parent, qPrintable(QString("Fork %1 stepped on its own thread differs").arg(i)));
+    swmm_close(forks[i]);
+    swmm_deleteProject(forks[i]);
+  }
+
+  swmm_end(project);
+  swmm_close(project);
+  swmm_deleteProject(project);
+}
+
+void SWMMTestClass::forksClosedBeforeParent()
+{
+  Project *reference = startExample("test3");
+  QVERIFY(reference != nullptr);
+  QVector<double> unforked = stepResults(reference, -1);
+  swmm_end(reference);
+  swmm_close(reference);
+  swmm_deleteProject(reference);
+
+  Project *project = startExample("test3");
+  QVERIFY(project != nullptr);
+
+  QVector<double> parent = stepResults(project, 500);
+
+  //forks are closed at different points of their runs, all before the parent
+  for(int round = 0; round < 3; round++)
+  {
+    Project *forks[2];
+    QVERIFY(swmm_fork(project, 2, forks) == 0);
+
+    stepResults(forks[0], 100 * round);
+    stepResults(forks[1], -1);
+
+    for(int i = 0; i < 2; i++)
+    {
+      QVERIFY(forks[i]->ErrorCode == 0);
+      QVERIFY(swmm_close(forks[i]) == 0);
+      swmm_deleteProject(forks[i]);
+    }
+
+    parent += stepResults(project, 100);
+  }
+
+  parent += stepResults(project, -1);
+
+  QVERIFY(project->ErrorCode == 0);
+  QVERIFY2(parent == unforked, "Forking changed the parent's results");
+
+  QVERIFY(swmm_end(project) == 0);
+  QVERIFY(swmm_close(project) == 0);
+  swmm_deleteProject(project);
+}
+
+void SWMMTestClass::exchangeWhileStepping()
+{
+  Project *project = startExample("test1");
+  QVERIFY(project != nullptr);
+
+  const int nodes = project->Nobjects[NODE];
+  std::atomic<bool> done(false);
+  std::atomic<int> producerErrors(0);
+  std::atomic<unsigned int> lastPublished(0);
+
+  //epoch e sets every node's lateral inflow to e / 1000 cfs
+  std::thread producer([&]()
+  {
+    QVector<int> indexes(nodes);
+    QVector<double> values(nodes);
+
+    for(int i = 0; i < nodes; i++)
+      indexes[i] = i;
+
+    while(!done.load())
+    {
+      if(!beginExchange(project, EXCHANGE_NODE_LATERAL_INFLOW))
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      unsigned int epoch = lastPublished.load() + 1;
+      values.fill(epoch / 1000.0);
+      setExchangeValues(project, EXCHANGE_NODE_LATERAL_INFLOW, nodes, indexes.constData(), values.constData());
+
+      if(publishExchange(project, EXCHANGE_NODE_LATERAL_INFLOW) != epoch)
+        producerErrors++;
+
+      lastPublished.store(epoch);
+    }
+  });
+
+  QVector<int> indexes(nodes);
+  QVector<double> values(nodes);
+
+  for(int i = 0; i < nodes; i++)
+    indexes[i] = i;
+
+  unsigned int previous = 0;
+  int stepsWithValues = 0;
+  QString failure;
+  double elapsedTime = 0.0;
+
+  do
+  {
+    if(swmm_step(project, &elapsedTime))
+    {
+      failure = "swmm_step failed";
+      break;
+    }
+
+    unsigned int consumed = 0;
+    unsigned int published = getExchangeEpoch(project, EXCHANGE_NODE_LATERAL_INFLOW, &consumed);
+
+    if(consumed < previous || consumed > published)
+    {
+      failure = QString("consumed epoch %1 after %2 with %3 published").arg(consumed).arg(previous).arg(published);
+      break;
+    }
+
+    previous = consumed;
+
+    if(consumed == 0)
+      continue;
+
+    //every value applied must come from the epoch consumed
+    values.fill(-1.0);
+
+    if(getNodeLateralInflows(project, nodes, indexes.constData(), values.data()) != nodes)
+    {
+      failure = QString("epoch %1 is missing values").arg(consumed);
+      break;
+    }
+
+    for(int i = 0; i < nodes && failure.isEmpty(); i++)
+    {
+      if(values[i] != consumed / 1000.0)
+        failure = QString("node %1 has %2 in epoch %3").arg(i).arg(values[i]).arg(consumed);
+    }
+
+    stepsWithValues++;
+  } while(elapsedTime > 0.0 && failure.isEmpty());
+
+  done.store(true);
+  producer.join();
+
+  QVERIFY2(failure.isEmpty(), qPrintable(failure));
+  QVERIFY(producerErrors.load() == 0);
+  QVERIFY(stepsWithValues > 0);
+
+  swmm_end(project);
+  swmm_close(project);
+  swmm_deleteProject(project);
+}
+
 void SWMMTestClass::cleanup()
 {
 
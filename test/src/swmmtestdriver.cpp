@@ -23,6 +23,9 @@
 
 #include <cstdio>
 #include "swmmtestclass.h"
+#include "swmmbenchmarkclass.h"
+#include "swmmscalingbenchmarkclass.h"
+#include "swmmregressionclass.h"
 
 int main(int argc, char** argv)
 {
@@ -34,6 +37,24 @@ int main(int argc, char** argv)
      status |= QTest::qExec(&swmmTestObject, argc, argv);
    }
 
+   //Kernel benchmarks
+   {
+     SWMMBenchmarkClass swmmBenchmarkObject;
+     status |= QTest::qExec(&swmmBenchmarkObject, argc, argv);
+   }
+
+   //Synthetic network scaling
+   {
+     SWMMScalingBenchmarkClass swmmScalingBenchmarkObject;
+     status |= QTest::qExec(&swmmScalingBenchmarkObject, argc, argv);
+   }
+
+   //Example and synthetic network regressions
+   {
+     SWMMRegressionClass swmmRegressionObject;
+     status |= QTest::qExec(&swmmRegressionObject, argc, argv);
+   }
+
    return status;
 }
 